@@ -28,17 +28,167 @@ void access_code_correlator_init(
 	const size_t maximum_hamming_distance
 ) {
 	correlator->code = code;
-	correlator->mask = (1ULL << code_length) - 1;
 	correlator->history = 0;
-	correlator->maximum_hamming_distance = maximum_hamming_distance;
+	correlator->code_length = (code_length < 64) ? code_length : 64;
+	correlator->maximum_hamming_distance = (maximum_hamming_distance < ACCESS_CODE_DISTANCE_MAX) ? maximum_hamming_distance : ACCESS_CODE_DISTANCE_MAX;
 }
 
-bool access_code_correlator_execute(
+/* Stream as 96 bits, newest symbol in bit 0 of lo. Bit m of plane j is
+ * code bit j for the candidate ending m symbols before the newest one,
+ * so every end position in the word is tested together, bit-sliced.
+ */
+typedef struct access_code_window_t {
+	uint32_t lo;
+	uint32_t mid;
+	uint32_t hi;
+	size_t unused;
+} access_code_window_t;
+
+static access_code_window_t access_code_window_shift(
+	uint64_t* const history,
+	const uint32_t symbols,
+	const size_t symbol_count
+) {
+	access_code_window_t window;
+	window.unused = 32 - symbol_count;
+	const uint64_t shifted = (*history << symbol_count) | (symbols >> window.unused);
+	window.lo = (uint32_t)shifted;
+	window.mid = (uint32_t)(shifted >> 32);
+	window.hi = (uint32_t)(*history >> (64 - symbol_count));
+	*history = shifted;
+	return window;
+}
+
+static inline uint32_t access_code_window_plane(const access_code_window_t* const window, const size_t j) {
+	if( j == 0 ) {
+		return window->lo;
+	} else if( j < 32 ) {
+		return (window->lo >> j) | (window->mid << (32 - j));
+	} else if( j == 32 ) {
+		return window->mid;
+	} else {
+		return (window->mid >> (j - 32)) | (window->hi << (64 - j));
+	}
+}
+
+/* Each lane's counter starts at the allowed distance and counts down on a
+ * mismatch; a borrow out of the top plane marks the lane dead. With
+ * random input nearly every lane dies within a few code bits, and the
+ * loop stops as soon as all have. The M4 has no popcount instruction;
+ * this is much cheaper than 32 of them.
+ */
+static uint32_t access_code_match(
+	const access_code_window_t* const window,
+	const uint64_t code,
+	const size_t code_length,
+	const size_t maximum_hamming_distance,
+	size_t* const best_distance
+) {
+	const size_t planes = maximum_hamming_distance ? (32 - __builtin_clz(maximum_hamming_distance)) : 0;
+	uint32_t count[7];
+	for(size_t b=0; b<planes; b++) {
+		count[b] = ((maximum_hamming_distance >> b) & 1) ? 0xffffffff : 0;
+	}
+
+	/* Lanes m >= symbol_count are from an earlier word. */
+	uint32_t dead = ~(0xffffffff >> window->unused);
+	for(size_t j=0; j<code_length; j++) {
+		const uint32_t code_bit = ((code >> j) & 1) ? 0xffffffff : 0;
+		uint32_t borrow = (access_code_window_plane(window, j) ^ code_bit) & ~dead;
+		for(size_t b=0; borrow && (b<planes); b++) {
+			const uint32_t difference = count[b] ^ borrow;
+			borrow &= ~count[b];
+			count[b] = difference;
+		}
+		dead |= borrow;
+		if( dead == 0xffffffff ) {
+			return 0;
+		}
+	}
+
+	const uint32_t alive = ~dead;
+	if( best_distance ) {
+		/* Most count left over is the smallest distance. */
+		uint32_t candidates = alive;
+		size_t remaining = 0;
+		for(size_t b=planes; b>0; b--) {
+			if( candidates & count[b - 1] ) {
+				candidates &= count[b - 1];
+				remaining |= 1 << (b - 1);
+			}
+		}
+		*best_distance = maximum_hamming_distance - remaining;
+	}
+
+	/* Lane m is symbol k = symbol_count - 1 - m; move it to bit 31 - k. */
+	return alive << window->unused;
+}
+
+uint32_t access_code_correlator_execute_word(
 	access_code_correlator_t* const correlator,
-	const uint_fast8_t in
+	const uint32_t symbols,
+	const size_t symbol_count
 ) {
-	correlator->history = (correlator->history << 1) | in;
-	const uint64_t delta_bits = (correlator->history ^ correlator->code) & correlator->mask;
-	const size_t count = __builtin_popcountll(delta_bits);
-	return (count <= correlator->maximum_hamming_distance);
+	const access_code_window_t window = access_code_window_shift(&correlator->history, symbols, symbol_count);
+	return access_code_match(&window, correlator->code, correlator->code_length, correlator->maximum_hamming_distance, NULL);
+}
+
+size_t access_code_correlator_distance(
+	const access_code_correlator_t* const correlator,
+	const size_t symbol_count,
+	const size_t k
+) {
+	const uint64_t mask = (correlator->code_length < 64) ? ((1ULL << correlator->code_length) - 1) : ~0ULL;
+	const uint64_t window = correlator->history >> (symbol_count - 1 - k);
+	return __builtin_popcountll((window ^ correlator->code) & mask);
+}
+
+void access_code_correlator_bank_init(
+	access_code_correlator_bank_t* const bank
+) {
+	bank->history = 0;
+	bank->code_count = 0;
+}
+
+size_t access_code_correlator_bank_add(
+	access_code_correlator_bank_t* const bank,
+	const uint64_t code,
+	const size_t code_length,
+	const size_t maximum_hamming_distance
+) {
+	const size_t index = bank->code_count;
+	if( index < ACCESS_CODE_CORRELATOR_BANK_SIZE ) {
+		bank->codes[index].code = code;
+		bank->codes[index].code_length = (code_length < 64) ? code_length : 64;
+		bank->codes[index].maximum_hamming_distance = (maximum_hamming_distance < ACCESS_CODE_DISTANCE_MAX) ? maximum_hamming_distance : ACCESS_CODE_DISTANCE_MAX;
+		bank->code_count += 1;
+	}
+	return index;
+}
+
+uint32_t access_code_correlator_bank_execute_word(
+	access_code_correlator_bank_t* const bank,
+	const uint32_t symbols,
+	const size_t symbol_count,
+	uint32_t* const hits,
+	size_t* const best_distance
+) {
+	const access_code_window_t window = access_code_window_shift(&bank->history, symbols, symbol_count);
+
+	uint32_t codes_found = 0;
+	size_t best = ACCESS_CODE_DISTANCE_MAX + 1;
+	for(size_t i=0; i<bank->code_count; i++) {
+		const access_code_t* const c = &bank->codes[i];
+		size_t distance;
+		hits[i] = access_code_match(&window, c->code, c->code_length, c->maximum_hamming_distance, &distance);
+		if( hits[i] ) {
+			codes_found |= 1 << i;
+			best = (distance < best) ? distance : best;
+		}
+	}
+
+	if( codes_found ) {
+		*best_distance = best;
+	}
+	return codes_found;
 }
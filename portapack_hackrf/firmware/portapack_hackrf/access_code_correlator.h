@@ -26,10 +26,13 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+/* Distances above this are clamped; the matcher counts in seven bit planes. */
+#define ACCESS_CODE_DISTANCE_MAX 127
+
 typedef struct access_code_correlator_t {
 	uint64_t code;
-	uint64_t mask;
 	uint64_t history;
+	size_t code_length;
 	size_t maximum_hamming_distance;
 } access_code_correlator_t;
 
@@ -40,9 +43,70 @@ void access_code_correlator_init(
 	const size_t maximum_hamming_distance
 );
 
-bool access_code_correlator_execute(
+/* Up to 32 symbols at once, packed first symbol in bit 31. Only the top
+ * symbol_count (1 to 32) bits are used. Returns hits in the same bit positions:
+ * bit (31 - k) is set if the access code ends with symbol k.
+ */
+uint32_t access_code_correlator_execute_word(
 	access_code_correlator_t* const correlator,
-	const uint_fast8_t in
+	const uint32_t symbols,
+	const size_t symbol_count
+);
+
+/* Hamming distance of the hit on symbol k of the word just passed to
+ * access_code_correlator_execute_word(). History older than 64 symbols
+ * is gone, so code bits before that count as zeros.
+ */
+size_t access_code_correlator_distance(
+	const access_code_correlator_t* const correlator,
+	const size_t symbol_count,
+	const size_t k
+);
+
+/* Several access codes checked against one bit history, for receivers
+ * that listen for more than one protocol or preamble variant. Each code
+ * has its own length and maximum Hamming distance, clamped as for the
+ * single correlator.
+ */
+#define ACCESS_CODE_CORRELATOR_BANK_SIZE 16
+
+typedef struct access_code_t {
+	uint64_t code;
+	size_t code_length;
+	size_t maximum_hamming_distance;
+} access_code_t;
+
+typedef struct access_code_correlator_bank_t {
+	uint64_t history;
+	size_t code_count;
+	access_code_t codes[ACCESS_CODE_CORRELATOR_BANK_SIZE];
+} access_code_correlator_bank_t;
+
+void access_code_correlator_bank_init(
+	access_code_correlator_bank_t* const bank
+);
+
+/* Returns the index of the code, for the result masks below. Codes past
+ * ACCESS_CODE_CORRELATOR_BANK_SIZE are not added.
+ */
+size_t access_code_correlator_bank_add(
+	access_code_correlator_bank_t* const bank,
+	const uint64_t code,
+	const size_t code_length,
+	const size_t maximum_hamming_distance
+);
+
+/* Symbols are packed as for access_code_correlator_execute_word(), and
+ * hits[i] is that function's result for code i. Returns a mask with bit i
+ * set if code i was found; if any was, best_distance is the smallest
+ * Hamming distance among all hits.
+ */
+uint32_t access_code_correlator_bank_execute_word(
+	access_code_correlator_bank_t* const bank,
+	const uint32_t symbols,
+	const size_t symbol_count,
+	uint32_t* const hits,
+	size_t* const best_distance
 );
 
 #endif/*__ACCESS_CODE_CORRELATOR_H__*/
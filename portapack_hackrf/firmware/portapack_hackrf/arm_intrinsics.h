@@ -48,6 +48,36 @@ __attribute__((always_inline)) static inline uint32_t __QSUB16(uint32_t RN, uint
 	return RD;
 }
 
+__attribute__((always_inline)) static inline uint32_t __QADD8(uint32_t RN, uint32_t RM) {
+	uint32_t RD;
+	__asm volatile("qadd8 %0, %1, %2"
+		: "=r"(RD)
+		: "r"(RN),
+		  "r"(RM)
+	);
+	return RD;
+}
+
+__attribute__((always_inline)) static inline uint32_t __QSUB8(uint32_t RN, uint32_t RM) {
+	uint32_t RD;
+	__asm volatile("qsub8 %0, %1, %2"
+		: "=r"(RD)
+		: "r"(RN),
+		  "r"(RM)
+	);
+	return RD;
+}
+
+__attribute__((always_inline)) static inline uint32_t __SHADD16(uint32_t RN, uint32_t RM) {
+	uint32_t RD;
+	__asm volatile("shadd16 %0, %1, %2"
+		: "=r"(RD)
+		: "r"(RN),
+		  "r"(RM)
+	);
+	return RD;
+}
+
 __attribute__((always_inline)) static inline uint32_t __SMLATB(uint32_t RM, uint32_t RS, uint32_t RN) {
 	uint32_t RD;
 	__asm volatile("smlatb %0, %1, %2, %3"
@@ -70,6 +100,28 @@ __attribute__((always_inline)) static inline uint32_t __SMLABB(uint32_t RM, uint
 	return RD;
 }
 
+__attribute__((always_inline)) static inline uint32_t __SMLABT(uint32_t RM, uint32_t RS, uint32_t RN) {
+	uint32_t RD;
+	__asm volatile("smlabt %0, %1, %2, %3"
+		: "=r"(RD)
+		: "r"(RM),
+		  "r"(RS),
+		  "r"(RN)
+	);
+	return RD;
+}
+
+__attribute__((always_inline)) static inline uint32_t __SMLATT(uint32_t RM, uint32_t RS, uint32_t RN) {
+	uint32_t RD;
+	__asm volatile("smlatt %0, %1, %2, %3"
+		: "=r"(RD)
+		: "r"(RM),
+		  "r"(RS),
+		  "r"(RN)
+	);
+	return RD;
+}
+
 __attribute__((always_inline)) static inline uint32_t __SMUAD(uint32_t RM, uint32_t RS) {
 	uint32_t RD;
 	__asm volatile("smuad %0, %1, %2"
@@ -139,6 +191,26 @@ __attribute__((always_inline)) static inline uint32_t __SMUSDX(uint32_t RM, uint
 	return RD;
 }
 
+__attribute__((always_inline)) static inline uint32_t __SMULWB(uint32_t RN, uint32_t RM) {
+	uint32_t RD;
+	__asm volatile("smulwb %0, %1, %2"
+		: "=r"(RD)
+		: "r"(RN),
+		  "r"(RM)
+	);
+	return RD;
+}
+
+__attribute__((always_inline)) static inline uint32_t __SSAT(uint32_t RN, uint32_t SAT) {
+	uint32_t RD;
+	__asm volatile("ssat %0, %1, %2"
+		: "=r"(RD)
+		: "I"(SAT),
+		  "r"(RN)
+	);
+	return RD;
+}
+
 /* NOTE: BFI is kinda weird because it modifies RD, copy __SMLALD style? */
 __attribute__((always_inline)) static inline uint32_t __BFI(uint32_t RD, uint32_t RN, uint32_t LSB, uint32_t WIDTH) {
 	__asm volatile("bfi %0, %1, %2, %3"
@@ -203,6 +275,15 @@ __attribute__((always_inline)) static inline uint32_t __SXTAH(uint32_t RN, uint3
 	return RD;
 }
 
+__attribute__((always_inline)) static inline uint32_t __CLZ(uint32_t RM) {
+	uint32_t RD;
+	__asm volatile("clz %0, %1"
+		: "=r"(RD)
+		: "r"(RM)
+	);
+	return RD;
+}
+
 __attribute__((always_inline)) static inline uint32_t __RBIT(uint32_t RM) {
 	uint32_t RD;
 	__asm volatile("rbit %0, %1"
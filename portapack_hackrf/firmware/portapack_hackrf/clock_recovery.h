@@ -23,30 +23,172 @@
 #define __CLOCK_RECOVERY_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
-typedef void (*clock_recovery_symbol_handler_t)(const float value, void* const context);
+/* Symbol clock recovery on blocks of int16_t samples, in fixed point.
+ *
+ * A 32-bit phase accumulator advances by phase_increment (symbol rate /
+ * sample rate) plus a correction for every input sample. The sample where
+ * the top bit goes 1 -> 0 is a symbol, 0 -> 1 the midpoint between symbols;
+ * the value at the boundary is linearly interpolated from the samples on
+ * either side. The timing error detector runs once per
+ * symbol, and its low-passed output nudges the phase (not the frequency):
+ *
+ *   clock_recovery_gardner: (y[k] - y[k-1]) * y[k-1/2], for any signal
+ *     with transitions; doesn't need decisions.
+ *   clock_recovery_mueller_muller: a[k] * y[k-1] - a[k-1] * y[k], with
+ *     a = sign(y). Symbol samples only; needs pulses that are still
+ *     sloped at the symbol instants. A flat (square) envelope gives it
+ *     no error, use Gardner there.
+ *
+ * Both are normalized by signal level, so loop gain does not depend on
+ * amplitude. Positive error means sampling late, so the next symbol
+ * boundary is brought forward.
+ *
+ * Symbol samples are collected and handed to the sink in batches:
+ *
+ *	struct my_sink {
+ *		void operator()(const int16_t* const symbols, const size_t count);
+ *	};
+ *
+ * The detector and sink are template arguments, so everything inlines
+ * into the caller's loop: no calls per sample or per symbol.
+ */
+
+/* A full batch packs into one uint32_t, see clock_recovery_pack_symbols(). */
+#define CLOCK_RECOVERY_SYMBOLS_MAX 32
 
 typedef struct clock_recovery_t {
 	uint32_t phase;
-	uint32_t phase_last;
-	uint32_t phase_adjustment;
 	uint32_t phase_increment;
-	float t0, t1, t2;
-	float error_filtered;
-	clock_recovery_symbol_handler_t symbol_handler;
-	void* context;
+	int32_t phase_adjustment;
+	int32_t error_filtered;		/* Q15 */
+	int32_t t0, t1, t2;			/* Last symbol, midpoint, previous symbol */
+	int32_t sample_last;
+	uint32_t gain_shift;
 } clock_recovery_t;
 
+/* gain_shift: each symbol, phase moves by up to phase_increment >> gain_shift.
+ * 8 is about the loop gain of the old float version.
+ */
 void clock_recovery_init(
 	clock_recovery_t* const clock_recovery,
 	const float fractional_symbol_rate,
-	clock_recovery_symbol_handler_t symbol_handler,
-	void* const context
+	const uint32_t gain_shift
 );
 
-void clock_recovery_execute(
-	clock_recovery_t* const clock_recovery,
-	const float in
-);
+/* error / level in Q15, clamped to +/-1.0. Both are scaled down first if
+ * needed, so a single 32-bit division does.
+ */
+static inline int32_t clock_recovery_normalize(int32_t error, int32_t level) {
+	const int32_t shift = (level >> 15) ? (17 - __builtin_clz(level)) : 0;
+	level = (level >> shift) + 1;
+	error >>= shift;
+	error = (error > level) ? level : ((error < -level) ? -level : error);
+	return (error << 15) / level;
+}
+
+struct clock_recovery_gardner {
+	static inline int32_t error(const clock_recovery_t* const s) {
+		/* Halve the difference so the product stays within int32. */
+		const int32_t e = ((s->t0 - s->t2) >> 1) * s->t1;
+		const int32_t energy = ((s->t0 * s->t0) >> 1) + ((s->t2 * s->t2) >> 1);
+		return clock_recovery_normalize(e, energy);
+	}
+};
+
+struct clock_recovery_mueller_muller {
+	static inline int32_t error(const clock_recovery_t* const s) {
+		const int32_t a0 = (s->t0 >= 0) ? 1 : -1;
+		const int32_t a1 = (s->t2 >= 0) ? 1 : -1;
+		const int32_t e = a0 * s->t2 - a1 * s->t0;
+		const int32_t level = (((s->t0 >= 0) ? s->t0 : -s->t0) + ((s->t2 >= 0) ? s->t2 : -s->t2)) >> 1;
+		return clock_recovery_normalize(e, level);
+	}
+};
+
+/* Symbol decisions (>= 0 is a 1) packed first symbol in bit 31, for the
+ * word-at-a-time correlator and packet builder.
+ */
+static inline uint32_t clock_recovery_pack_symbols(const int16_t* const symbols, const size_t count) {
+	uint32_t packed = 0;
+	for(size_t n=0; n<count; n++) {
+		packed |= (uint32_t)(symbols[n] >= 0) << (31 - n);
+	}
+	return packed;
+}
+
+template<typename Detector>
+static inline void clock_recovery_symbol_update(clock_recovery_t* const s) {
+	const int32_t error = Detector::error(s);
+	s->error_filtered += (error - s->error_filtered) >> 2;
+	s->phase_adjustment = (int32_t)(((int64_t)s->phase_increment * s->error_filtered) >> (15 + s->gain_shift));
+}
+
+template<typename Detector, typename Sink>
+void clock_recovery_process(
+	clock_recovery_t* const s,
+	const int16_t* const in,
+	const size_t sample_count,
+	Sink& sink
+) {
+	int16_t symbols[CLOCK_RECOVERY_SYMBOLS_MAX];
+	size_t symbol_count = 0;
+
+	uint32_t phase = s->phase;
+	uint32_t phase_step = s->phase_increment + s->phase_adjustment;
+	int32_t sample_last = s->sample_last;
+
+	for(size_t n=0; n<sample_count; n++) {
+		const uint32_t phase_last = phase;
+		const uint32_t step = phase_step;
+		phase += step;
+		const int32_t sample = in[n];
+		const int32_t sample_previous = sample_last;
+		sample_last = sample;
+
+		/* Common case: no symbol or midpoint boundary in this sample. */
+		uint32_t distance = 0x80000000U - (phase_last & 0x7fffffffU);
+		if( distance > step ) {
+			continue;
+		}
+
+		/* At two samples per symbol, a fast transmitter can put both a
+		 * midpoint and a symbol boundary into one sample period.
+		 */
+		while(true) {
+			/* Fraction of the sample period (Q15) from boundary to in[n]. */
+			const int32_t mu = ((step - distance) >> 1) / (step >> 16);
+			const int32_t value = sample - (((sample - sample_previous) * mu) >> 15);
+
+			s->t2 = s->t1;
+			s->t1 = s->t0;
+			s->t0 = value;
+
+			if( ((phase_last + distance) >> 31) == 0 ) {
+				symbols[symbol_count++] = value;
+				if( symbol_count == CLOCK_RECOVERY_SYMBOLS_MAX ) {
+					sink(symbols, symbol_count);
+					symbol_count = 0;
+				}
+
+				clock_recovery_symbol_update<Detector>(s);
+				phase_step = s->phase_increment + s->phase_adjustment;
+			}
+
+			if( (step - distance) < 0x80000000U ) {
+				break;
+			}
+			distance += 0x80000000U;
+		}
+	}
+
+	if( symbol_count > 0 ) {
+		sink(symbols, symbol_count);
+	}
+
+	s->phase = phase;
+	s->sample_last = sample_last;
+}
 
 #endif/*__CLOCK_RECOVERY_H__*/
@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Also runs on a host:
+ *   g++ -DCLOCK_RECOVERY_TEST_HOST clock_recovery_test.cpp clock_recovery.cpp -o clock_recovery_test
+ */
+
+#include "clock_recovery_test.h"
+
+#include "clock_recovery.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CLOCK_RECOVERY_TEST_SYMBOLS 4000
+#define CLOCK_RECOVERY_TEST_ACQUIRE 200
+
+static uint32_t next_random(uint32_t* const x) {
+	*x = *x * 1103515245 + 12345;
+	return *x >> 16;
+}
+
+typedef struct symbol_log_t {
+	uint8_t bits[CLOCK_RECOVERY_TEST_SYMBOLS + 64];
+	size_t count;
+} symbol_log_t;
+
+struct symbol_log_sink {
+	symbol_log_t* const log;
+
+	void operator()(const int16_t* const symbols, const size_t count) {
+		for(size_t n=0; n<count; n++) {
+			if( log->count < sizeof(log->bits) ) {
+				log->bits[log->count] = symbols[n] >= 0;
+			}
+			log->count += 1;
+		}
+	}
+};
+
+/* The TPMS-ASK receiver's symbol timing: a square +/-1.0 (Q13) envelope
+ * of random bits at 8192 symbols/s times (1 + rate_offset_ppm / 1e6),
+ * sampled at 192kHz and fed in 128-sample blocks. After acquisition,
+ * every symbol must come out, with no slips and no errors.
+ */
+static int test_clock_recovery_gardner_square(const int32_t rate_offset_ppm, const uint32_t seed) {
+	uint8_t sent[CLOCK_RECOVERY_TEST_SYMBOLS];
+	uint32_t x = seed;
+	for(size_t k=0; k<CLOCK_RECOVERY_TEST_SYMBOLS; k++) {
+		sent[k] = next_random(&x) & 1;
+	}
+
+	clock_recovery_t clock_recovery;
+	clock_recovery_init(&clock_recovery, 8192.0f / 192000.0f, 6);
+
+	static symbol_log_t received;
+	received.count = 0;
+	symbol_log_sink sink = { &received };
+
+	/* Symbol position of each sample in 1/2^16ths, with a random start phase. */
+	const int64_t symbol_step = ((int64_t)8192 * (1000000 + rate_offset_ppm) << 16) / ((int64_t)192000 * 1000000);
+	int64_t position = next_random(&x);
+	while( (position >> 16) < CLOCK_RECOVERY_TEST_SYMBOLS ) {
+		int16_t block[128];
+		size_t n = 0;
+		for(; (n<128) && ((position >> 16) < CLOCK_RECOVERY_TEST_SYMBOLS); n++) {
+			block[n] = sent[position >> 16] ? 8192 : -8192;
+			position += symbol_step;
+		}
+		clock_recovery_process<clock_recovery_gardner>(&clock_recovery, block, n, sink);
+	}
+
+	/* Start phase decides whether the first symbol comes out; allow it. */
+	if( (received.count + 1 < CLOCK_RECOVERY_TEST_SYMBOLS) || (received.count > CLOCK_RECOVERY_TEST_SYMBOLS + 1) ) {
+		return 0;
+	}
+
+	/* One alignment for the whole run: a slip would misalign the rest. */
+	for(size_t lag=0; lag<2; lag++) {
+		size_t errors = 0;
+		for(size_t k=CLOCK_RECOVERY_TEST_ACQUIRE; k<CLOCK_RECOVERY_TEST_SYMBOLS - 2; k++) {
+			errors += (received.bits[k + lag - 1] != sent[k]) ? 1 : 0;
+		}
+		if( errors == 0 ) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int test_clock_recovery() {
+	const int32_t rate_offsets_ppm[] = { -3000, -1000, 0, 1000, 3000 };
+	for(size_t i=0; i<sizeof(rate_offsets_ppm)/sizeof(rate_offsets_ppm[0]); i++) {
+		for(uint32_t seed=1; seed<=3; seed++) {
+			if( !test_clock_recovery_gardner_square(rate_offsets_ppm[i], seed) ) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void clock_recovery_test() {
+	halt_if_failed(test_clock_recovery());
+}
+
+#ifdef CLOCK_RECOVERY_TEST_HOST
+int main() {
+	return test_clock_recovery() ? 0 : 1;
+}
+#endif
@@ -19,25 +19,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#ifndef __ENVELOPE_H__
-#define __ENVELOPE_H__
+#ifndef __CLOCK_RECOVERY_TEST_H__
+#define __CLOCK_RECOVERY_TEST_H__
 
-typedef struct envelope_t {
-	float rise_factor;
-	float fall_factor;
-	float envelope;
-	float envelope_minimum;
-} envelope_t;
+void clock_recovery_test();
 
-void envelope_init(
-	envelope_t* const envelope,
-	const float rise_factor,
-	const float fall_factor
-);
-
-float envelope_execute(
-	envelope_t* const envelope,
-	const float magnitude
-);
-
-#endif/*__ENVELOPE_H__*/
+#endif/*__CLOCK_RECOVERY_TEST_H__*/
@@ -19,27 +19,171 @@
  * Boston, MA 02110-1301, USA.
  */
 
+#ifndef __CRC_H__
+#define __CRC_H__
+
 #include <cstddef>
 #include <cstdint>
 
-template<typename T> T crc(const uint8_t* const data, const size_t length) {
-	/* Inspired by
-	 * http://www.barrgroup.com/Embedded-Systems/How-To/CRC-Calculation-C-Code
-	 */
-	const size_t width = 8 * sizeof(T);
-	const T polynomial = 0x1021;
-	const T top_bit = 1 << (width - 1);
-	T remainder = ~((T)0);
-	for(size_t byte=0; byte<length; ++byte) {
-		remainder ^= data[byte] << (width - 8);
-		for(size_t bit=8; bit>0; --bit) {
-			if( remainder & top_bit ) {
-				remainder = (remainder << 1) ^ polynomial;
+#include <type_traits>
+
+#include "index_list.h"
+
+/* Table-driven CRC for any width from 8 to 32 bits, with the parameters
+ * of the usual catalogue (Williams / reveng):
+ *
+ *	typedef crc_engine<16, 0x1021, 0xffff, true, true, 0xffff> crc_16_x25_t;
+ *
+ *	crc_16_x25_t crc;
+ *	crc.update(data, length);	// as often as needed
+ *	const uint16_t fcs = crc.value();
+ *
+ * Tables are generated at compile time and land in flash. update() uses
+ * one 256-entry table, a byte per lookup. update_slice4() adds three more
+ * tables and does four bytes per step, for long buffers.
+ *
+ * Reflected CRCs run in a right-aligned register. Non-reflected ones run
+ * left-aligned in 32 bits, so every width shares the same code, and their
+ * tables store only the top Width bits.
+ */
+
+static constexpr uint32_t crc_reflect(const uint32_t value, const size_t bits) {
+	return (bits == 0) ? 0 : (((value & 1) << (bits - 1)) | crc_reflect(value >> 1, bits - 1));
+}
+
+template<size_t Width>
+struct crc_value {
+	static_assert((Width >= 8) && (Width <= 32), "CRC width must be 8 to 32 bits");
+	typedef typename std::conditional<(Width <= 8), uint8_t,
+		typename std::conditional<(Width <= 16), uint16_t, uint32_t>::type
+	>::type type;
+};
+
+template<size_t Width, uint32_t Poly, bool RefIn>
+struct crc_table_generator {
+	static constexpr size_t shift = 32 - Width;
+	static constexpr uint32_t poly_reflected = crc_reflect(Poly, Width);
+	static constexpr uint32_t poly_aligned = Poly << shift;
+
+	static constexpr uint32_t step(const uint32_t r) {
+		return RefIn ?
+			((r & 1) ? ((r >> 1) ^ poly_reflected) : (r >> 1)) :
+			((r & 0x80000000) ? ((r << 1) ^ poly_aligned) : (r << 1));
+	}
+
+	static constexpr uint32_t steps(const uint32_t r, const size_t n) {
+		return (n == 0) ? r : steps(step(r), n - 1);
+	}
+
+	/* Register contents after shifting out byte i, then k more zero bytes. */
+	static constexpr uint32_t entry(const size_t k, const uint32_t i) {
+		return (k == 0) ?
+			(RefIn ? steps(i, 8) : steps(i << 24, 8)) :
+			(RefIn ?
+				((entry(k - 1, i) >> 8) ^ entry(0, entry(k - 1, i) & 0xff)) :
+				((entry(k - 1, i) << 8) ^ entry(0, entry(k - 1, i) >> 24)));
+	}
+
+	static constexpr typename crc_value<Width>::type stored(const size_t k, const uint32_t i) {
+		return RefIn ? entry(k, i) : (entry(k, i) >> shift);
+	}
+};
+
+template<typename Generator, typename List>
+struct crc_tables;
+
+template<typename Generator, size_t... I>
+struct crc_tables<Generator, index_list<I...>> {
+	typedef decltype(Generator::stored(0, 0)) value_t;
+	static constexpr value_t t0[sizeof...(I)] = { Generator::stored(0, I)... };
+	static constexpr value_t t1[sizeof...(I)] = { Generator::stored(1, I)... };
+	static constexpr value_t t2[sizeof...(I)] = { Generator::stored(2, I)... };
+	static constexpr value_t t3[sizeof...(I)] = { Generator::stored(3, I)... };
+};
+
+template<typename Generator, size_t... I>
+constexpr typename crc_tables<Generator, index_list<I...>>::value_t crc_tables<Generator, index_list<I...>>::t0[sizeof...(I)];
+template<typename Generator, size_t... I>
+constexpr typename crc_tables<Generator, index_list<I...>>::value_t crc_tables<Generator, index_list<I...>>::t1[sizeof...(I)];
+template<typename Generator, size_t... I>
+constexpr typename crc_tables<Generator, index_list<I...>>::value_t crc_tables<Generator, index_list<I...>>::t2[sizeof...(I)];
+template<typename Generator, size_t... I>
+constexpr typename crc_tables<Generator, index_list<I...>>::value_t crc_tables<Generator, index_list<I...>>::t3[sizeof...(I)];
+
+template<size_t Width, uint32_t Poly, uint32_t Init, bool RefIn, bool RefOut, uint32_t XorOut>
+class crc_engine {
+public:
+	typedef typename crc_value<Width>::type value_t;
+
+	crc_engine() :
+		_register(initial()) {
+	}
+
+	void reset() {
+		_register = initial();
+	}
+
+	void update(const uint8_t byte) {
+		if( RefIn ) {
+			_register = (_register >> 8) ^ tables::t0[(_register ^ byte) & 0xff];
+		} else {
+			_register = (_register << 8) ^ lookup(tables::t0, (_register >> 24) ^ byte);
+		}
+	}
+
+	void update(const uint8_t* const data, const size_t length) {
+		for(size_t i=0; i<length; i++) {
+			update(data[i]);
+		}
+	}
+
+	void update_slice4(const uint8_t* const data, const size_t length) {
+		size_t i = 0;
+		for(; (i+4)<=length; i+=4) {
+			if( RefIn ) {
+				const uint32_t x = _register ^
+					(data[i+0] | (data[i+1] << 8) | (data[i+2] << 16) | ((uint32_t)data[i+3] << 24));
+				_register =
+					tables::t3[x & 0xff] ^ tables::t2[(x >> 8) & 0xff] ^
+					tables::t1[(x >> 16) & 0xff] ^ tables::t0[x >> 24];
 			} else {
-				remainder = (remainder << 1);
+				const uint32_t x = _register ^
+					(((uint32_t)data[i+0] << 24) | (data[i+1] << 16) | (data[i+2] << 8) | data[i+3]);
+				_register =
+					lookup(tables::t3, x >> 24) ^ lookup(tables::t2, (x >> 16) & 0xff) ^
+					lookup(tables::t1, (x >> 8) & 0xff) ^ lookup(tables::t0, x & 0xff);
 			}
 		}
+		update(&data[i], length - i);
 	}
-	return remainder;
-}
 
+	value_t value() const {
+		const uint32_t r = RefIn ? _register : (_register >> generator::shift);
+		return ((RefIn != RefOut) ? crc_reflect(r, Width) : r) ^ XorOut;
+	}
+
+	static value_t checksum(const uint8_t* const data, const size_t length) {
+		crc_engine crc;
+		crc.update_slice4(data, length);
+		return crc.value();
+	}
+
+private:
+	typedef crc_table_generator<Width, Poly, RefIn> generator;
+	typedef crc_tables<generator, make_index_list<256>::type> tables;
+
+	uint32_t _register;
+
+	static constexpr uint32_t initial() {
+		return RefIn ? crc_reflect(Init, Width) : (Init << generator::shift);
+	}
+
+	static uint32_t lookup(const value_t* const table, const uint32_t index) {
+		return (uint32_t)table[index] << generator::shift;
+	}
+};
+
+/* HDLC frame check sequence, as used by AIS. */
+typedef crc_engine<16, 0x1021, 0xffff, true, true, 0xffff> crc_16_x25_t;
+
+#endif/*__CRC_H__*/
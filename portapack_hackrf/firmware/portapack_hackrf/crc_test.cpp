@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Also runs on a host:
+ *   g++ -std=c++11 -DCRC_TEST_HOST crc_test.cpp -o crc_test
+ */
+
+#include "crc_test.h"
+
+#include "crc.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+static const uint8_t check_input[] = { '1', '2', '3', '4', '5', '6', '7', '8', '9' };
+
+/* Bit at a time, straight from the parameter definitions. */
+static uint32_t reference_crc(
+	const size_t width, const uint32_t poly, const uint32_t init,
+	const bool ref_in, const bool ref_out, const uint32_t xor_out,
+	const uint8_t* const data, const size_t length
+) {
+	const uint32_t top_bit = 1UL << (width - 1);
+	const uint32_t mask = (width == 32) ? 0xffffffff : ((1UL << width) - 1);
+	uint32_t r = init;
+	for(size_t i=0; i<length; i++) {
+		const uint32_t byte = ref_in ? crc_reflect(data[i], 8) : data[i];
+		for(size_t bit=8; bit>0; bit--) {
+			const uint32_t in = (byte >> (bit - 1)) & 1;
+			const uint32_t out = (r & top_bit) ? 1 : 0;
+			r = ((r << 1) & mask) ^ ((in ^ out) ? poly : 0);
+		}
+	}
+	return (ref_out ? crc_reflect(r, width) : r) ^ xor_out;
+}
+
+template<size_t Width, uint32_t Poly, uint32_t Init, bool RefIn, bool RefOut, uint32_t XorOut>
+static int test_crc_engine(const uint32_t check) {
+	typedef crc_engine<Width, Poly, Init, RefIn, RefOut, XorOut> engine_t;
+
+	if( engine_t::checksum(check_input, sizeof(check_input)) != check ) {
+		return 0;
+	}
+
+	/* Every length and split point: bytewise, block and slice-by-4 agree. */
+	uint8_t data[37];
+	uint32_t x = 0x12345678;
+	for(size_t i=0; i<sizeof(data); i++) {
+		x = x * 1103515245 + 12345;
+		data[i] = x >> 24;
+	}
+
+	for(size_t length=0; length<=sizeof(data); length++) {
+		const uint32_t expected = reference_crc(Width, Poly, Init, RefIn, RefOut, XorOut, data, length);
+		for(size_t split=0; split<=length; split++) {
+			engine_t a;
+			a.update(data, split);
+			a.update(&data[split], length - split);
+
+			engine_t b;
+			b.update_slice4(data, split);
+			b.update_slice4(&data[split], length - split);
+
+			if( (a.value() != expected) || (b.value() != expected) ) {
+				return 0;
+			}
+		}
+	}
+
+	return 1;
+}
+
+static int test_crc_engines() {
+	return
+		test_crc_engine<8, 0x07, 0x00, false, false, 0x00>(0xf4) &&					/* CRC-8 */
+		test_crc_engine<8, 0x31, 0x00, true, true, 0x00>(0xa1) &&					/* CRC-8/MAXIM */
+		test_crc_engine<16, 0x1021, 0xffff, false, false, 0x0000>(0x29b1) &&		/* CRC-16/CCITT-FALSE */
+		test_crc_engine<16, 0x1021, 0x0000, false, false, 0x0000>(0x31c3) &&		/* CRC-16/XMODEM */
+		test_crc_engine<16, 0x1021, 0xffff, true, true, 0xffff>(0x906e) &&			/* CRC-16/X-25 */
+		test_crc_engine<16, 0x8005, 0x0000, true, true, 0x0000>(0xbb3d) &&			/* CRC-16/ARC */
+		test_crc_engine<24, 0x864cfb, 0xb704ce, false, false, 0x000000>(0x21cf02) &&	/* CRC-24/OPENPGP */
+		test_crc_engine<32, 0x04c11db7, 0xffffffff, true, true, 0xffffffff>(0xcbf43926) &&	/* CRC-32 */
+		test_crc_engine<32, 0x04c11db7, 0xffffffff, false, false, 0xffffffff>(0xfc891918);	/* CRC-32/BZIP2 */
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void crc_test() {
+	halt_if_failed(test_crc_engines());
+}
+
+#ifdef CRC_TEST_HOST
+int main() {
+	return test_crc_engines() ? 0 : 1;
+}
+#endif
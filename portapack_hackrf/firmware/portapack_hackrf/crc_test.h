@@ -19,28 +19,9 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#include "envelope.h"
+#ifndef __CRC_TEST_H__
+#define __CRC_TEST_H__
 
-void envelope_init(
-	envelope_t* const envelope,
-	const float rise_factor,
-	const float fall_factor
-) {
-	envelope->rise_factor = rise_factor;
-	envelope->fall_factor = fall_factor;
-	envelope->envelope_minimum = 0.000001f;
-	envelope->envelope = envelope->envelope_minimum;
-}
+void crc_test();
 
-float envelope_execute(
-	envelope_t* const envelope,
-	const float magnitude
-) {
-	if( magnitude > envelope->envelope ) {
-		envelope->envelope = envelope->envelope * (1.0f - envelope->rise_factor) + magnitude * envelope->rise_factor;
-	} else {
-		envelope->envelope = envelope->envelope * (1.0f - envelope->fall_factor) + magnitude * envelope->fall_factor;
-	}
-	const float out = (2.0f * magnitude / (envelope->envelope + envelope->envelope_minimum)) - 1.0f;
-	return out;
-}
+#endif/*__CRC_TEST_H__*/
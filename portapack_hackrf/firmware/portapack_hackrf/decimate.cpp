@@ -406,7 +406,8 @@ void fir_64_decim_2_real_s16_s16_init(
 ) {
 	state->taps = taps;
 	state->taps_count = ((taps_count + 3) >> 2) * 4;
-	for(uint32_t i=0; i<state->taps_count + 2; i++) {
+	state->z_index = 0;
+	for(uint32_t i=0; i<state->taps_count * 2; i++) {
 		state->z[i] = 0;
 	}
 }
@@ -420,27 +421,47 @@ size_t fir_64_decim_2_real_s16_s16(
 	/* int16_t input (sample count "n" must be multiple of 4)
 	 * -> int16_t output, decimated by 2.
 	 * taps are normalized to 1 << 16 == 1.0.
+	 * taps must be word-aligned, as they're fetched in pairs.
 	 */
 
+	/* Delay line is circular, and each incoming sample pair is written
+	 * twice: at z_index and at z_index + taps_count. The oldest taps_count
+	 * samples are then always found contiguously at z[z_index], so nothing
+	 * is shifted, and tap/sample pairs can be fed to SMLALD a word at a
+	 * time. z_index stays even, so the window is always word-aligned.
+	 *
+	 * Output k = sum(taps[j] * x[2k-taps_count+j]), identical to the
+	 * previous shifting implementation (new samples enter the window on the
+	 * following output).
+	 */
+	const size_t taps_count = state->taps_count;
+	const uint32_t* const taps = (const uint32_t*)state->taps;
+	uint32_t* const z = (uint32_t*)&state->z[0];
+	size_t z_index = state->z_index >> 1;
+	const uint32_t* s = (const uint32_t*)src;
+
 	int32_t n = sample_count;
 	for(; n>0; n-=2) {
-		state->z[state->taps_count + 0] = *(src++);
-		state->z[state->taps_count + 1] = *(src++);
+		const uint32_t s1_s0 = *(s++);
 
 		int64_t t = 0;
-		for(uint32_t j=0; j<state->taps_count; j+=4) {
-			t += state->z[j+0] * state->taps[j+0];
-			t += state->z[j+1] * state->taps[j+1];
-			t += state->z[j+2] * state->taps[j+2];
-			t += state->z[j+3] * state->taps[j+3];
-
-			state->z[j+0] = state->z[j+0+2];
-			state->z[j+1] = state->z[j+1+2];
-			state->z[j+2] = state->z[j+2+2];
-			state->z[j+3] = state->z[j+3+2];
+		const uint32_t* zp = &z[z_index];
+		const uint32_t* tp = taps;
+		for(size_t j=0; j<taps_count; j+=4) {
+			t = __SMLALD(t, *(zp++), *(tp++));	/* 1: t += z[j+1]*tap[j+1] + z[j+0]*tap[j+0] */
+			t = __SMLALD(t, *(zp++), *(tp++));	/* 1: t += z[j+3]*tap[j+3] + z[j+2]*tap[j+2] */
 		}
+
+		z[z_index] = s1_s0;
+		z[z_index + (taps_count >> 1)] = s1_s0;
+		z_index += 1;
+		if( z_index == (taps_count >> 1) ) {
+			z_index = 0;
+		}
+
 		*(dst++) = t / 65536;
 	}
+	state->z_index = z_index << 1;
 
 	return sample_count / 2;
 }
@@ -452,8 +473,10 @@ void fir_64_decim_8_cplx_s16_s16_init(
 ) {
 	state->taps = taps;
 	state->taps_count = ((taps_count + 7) >> 3) * 8;
-	for(uint32_t i=0; i<state->taps_count + 8; i++) {
-		state->z[i] = { 0, 0 };
+	state->z_index = 0;
+	for(uint32_t i=0; i<state->taps_count * 2; i++) {
+		state->z_i[i] = 0;
+		state->z_q[i] = 0;
 	}
 }
 
@@ -466,86 +489,347 @@ size_t fir_64_decim_8_cplx_s16_s16(
 	/* complex<int16_t> input (sample count "n" must be multiple of 8)
 	 * -> complex<int16_t> output, decimated by 8.
 	 * taps are normalized to 1 << 16 == 1.0.
+	 * taps must be word-aligned, as they're fetched in pairs.
+	 */
+
+	/* Only every eighth output is computed, against a circular delay line
+	 * that is never shifted. Incoming samples are split into I and Q planes
+	 * as they're written (once per sample), so the MAC loop (eight times per
+	 * sample) is just loads and SMLALDs: each word holds two consecutive I
+	 * (or Q) samples, matching a word of two consecutive taps. With real taps,
+	 * SMLALDX on interleaved Q:I words would only produce cross terms.
+	 *
+	 * As with fir_64_decim_2_real_s16_s16, each sample is written at z_index
+	 * and z_index + taps_count so the window at z_index is contiguous.
+	 * Output is identical to the previous shifting implementation.
 	 */
+	const size_t taps_count = state->taps_count;
+	const size_t z_words = taps_count >> 1;
+	const uint32_t* const taps = (const uint32_t*)state->taps;
+	uint32_t* const z_i = (uint32_t*)&state->z_i[0];
+	uint32_t* const z_q = (uint32_t*)&state->z_q[0];
+	size_t z_index = state->z_index >> 1;
+	const uint32_t* s = (const uint32_t*)src;
 
 	int32_t n = sample_count;
 	for(; n>0; n-=8) {
-		state->z[state->taps_count + 0] = *(src++);
-		state->z[state->taps_count + 1] = *(src++);
-		state->z[state->taps_count + 2] = *(src++);
-		state->z[state->taps_count + 3] = *(src++);
-		state->z[state->taps_count + 4] = *(src++);
-		state->z[state->taps_count + 5] = *(src++);
-		state->z[state->taps_count + 6] = *(src++);
-		state->z[state->taps_count + 7] = *(src++);
-		
 		int64_t i = 0;
 		int64_t q = 0;
-		for(uint32_t j=0; j<state->taps_count; j+=8) {
-			i += state->z[j+0].i * state->taps[j+0];
-			q += state->z[j+0].q * state->taps[j+0];
-			i += state->z[j+1].i * state->taps[j+1];
-			q += state->z[j+1].q * state->taps[j+1];
-			i += state->z[j+2].i * state->taps[j+2];
-			q += state->z[j+2].q * state->taps[j+2];
-			i += state->z[j+3].i * state->taps[j+3];
-			q += state->z[j+3].q * state->taps[j+3];
-			i += state->z[j+4].i * state->taps[j+4];
-			q += state->z[j+4].q * state->taps[j+4];
-			i += state->z[j+5].i * state->taps[j+5];
-			q += state->z[j+5].q * state->taps[j+5];
-			i += state->z[j+6].i * state->taps[j+6];
-			q += state->z[j+6].q * state->taps[j+6];
-			i += state->z[j+7].i * state->taps[j+7];
-			q += state->z[j+7].q * state->taps[j+7];
-
-			state->z[j+0] = state->z[j+0+8];
-			state->z[j+1] = state->z[j+1+8];
-			state->z[j+2] = state->z[j+2+8];
-			state->z[j+3] = state->z[j+3+8];
-			state->z[j+4] = state->z[j+4+8];
-			state->z[j+5] = state->z[j+5+8];
-			state->z[j+6] = state->z[j+6+8];
-			state->z[j+7] = state->z[j+7+8];
+		const uint32_t* zi = &z_i[z_index];
+		const uint32_t* zq = &z_q[z_index];
+		const uint32_t* tp = taps;
+		for(size_t j=0; j<taps_count; j+=4) {
+			const uint32_t t1_t0 = *(tp++);
+			const uint32_t t3_t2 = *(tp++);
+			i = __SMLALD(i, *(zi++), t1_t0);		/* 1: i += I1*T1 + I0*T0 */
+			q = __SMLALD(q, *(zq++), t1_t0);		/* 1: q += Q1*T1 + Q0*T0 */
+			i = __SMLALD(i, *(zi++), t3_t2);		/* 1: i += I3*T3 + I2*T2 */
+			q = __SMLALD(q, *(zq++), t3_t2);		/* 1: q += Q3*T3 + Q2*T2 */
 		}
+
+		for(size_t k=0; k<4; k++) {
+			const uint32_t q0_i0 = *(s++);
+			const uint32_t q1_i1 = *(s++);
+			const uint32_t i1_i0 = __PKHBT(q0_i0, q1_i1, 16);	/* 1: I1:I0 */
+			const uint32_t q1_q0 = __PKHTB(q1_i1, q0_i0, 16);	/* 1: Q1:Q0 */
+			z_i[z_index] = z_i[z_index + z_words] = i1_i0;
+			z_q[z_index] = z_q[z_index + z_words] = q1_q0;
+			z_index += 1;
+		}
+		if( z_index == z_words ) {
+			z_index = 0;
+		}
+
 		*(dst++) = { int16_t(i / 131072), int16_t(q / 131072) };
 	}
+	state->z_index = z_index << 1;
 
 	return sample_count / 8;
 }
-/*
-#include "arm_intrinsics.h"
 
-void fir_wbfm_decim_2_real_s16_s16_fast(fir_wbfm_decim_2_real_s16_s16_state_t* const state, int16_t* src, int16_t* dst, int32_t n) {
-	static const int16_t tap[] = {
-	    -27,    166,    104,    -36,   -174,   -129,    109,    287,    148,
-	   -232,   -430,   -130,    427,    597,     49,   -716,   -778,    137,
-	   1131,    957,   -493,  -1740,  -1121,   1167,   2733,   1252,  -2633,
-	  -4899,  -1336,   8210,  18660,  23254,  18660,   8210,  -1336,  -4899,
-	  -2633,   1252,   2733,   1167,  -1121,  -1740,   -493,    957,   1131,
-	    137,   -778,   -716,     49,    597,    427,   -130,   -430,   -232,
-	    148,    287,    109,   -129,   -174,    -36,    104,    166,    -27,
-	      0
-   	};
+/* Fold a 4k+3 tap half-band filter into its k+1 unique non-zero outer taps
+ * (doubled, to make up for the halved sample pair sums), padded with zeros
+ * to an even count so they can be fetched in pairs.
+ */
+static size_t fir_hb_fold_taps(
+	int16_t* const folded,
+	const size_t folded_max,
+	const int16_t* const taps,
+	const size_t taps_count
+) {
+	const size_t outer_count = (taps_count + 1) >> 2;
+	const size_t folded_count = (outer_count + 1) & ~1;
+	for(size_t j=0; j<folded_max; j++) {
+		folded[j] = (j < outer_count) ? (taps[j * 2] * 2) : 0;
+	}
+	return folded_count;
+}
+
+void fir_hb_decim_2_real_s16_s16_init(
+	fir_hb_decim_2_real_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+) {
+	const size_t taps_max = sizeof(state->taps) / sizeof(state->taps[0]);
+	state->taps_count = fir_hb_fold_taps(state->taps, taps_max, taps, taps_count);
+	state->center_delay = (taps_count - 3) >> 2;
+	state->z_count = (taps_count + 1) >> 1;
+	state->z_index = 0;
+	state->c_index = 0;
+	state->s3_s2 = 0;
+	for(size_t i=0; i<sizeof(state->z)/sizeof(state->z[0]); i++) {
+		state->z[i] = 0;
+	}
+	for(size_t i=0; i<sizeof(state->c)/sizeof(state->c[0]); i++) {
+		state->c[i] = 0;
+	}
+}
+
+size_t fir_hb_decim_2_real_s16_s16(
+	fir_hb_decim_2_real_s16_s16_state_t* const state,
+	int16_t* src,
+	int16_t* dst,
+	const size_t sample_count
+) {
+	/* int16_t input (sample count "n" must be multiple of 4)
+	 * -> int16_t output, decimated by 2. May run in place.
+	 *
+	 * With the output aligned to the second sample of each input pair, all
+	 * non-zero outer taps land on odd samples (A) and the centre tap on
+	 * even samples (B):
+	 *
+	 * y[k] = B[k-K] / 2 + sum(p=0..K, h[2p] * (A[k-p] + A[k-2K-1+p]))
+	 *
+	 * Two outputs are computed per iteration. z holds words of two
+	 * consecutive odd samples, D[m] = A[m+1]:A[m], so one SHADD16 of
+	 * D[k-p] and D[k-2K-1+p] yields the pair sums for both y[k] and
+	 * y[k+1], and the MACs pick the halves with SMLAxy.
+	 */
+	const size_t taps_count = state->taps_count;
+	const size_t center_delay = state->center_delay;
+	const size_t z_count = state->z_count;
+	const size_t c_count = sizeof(state->c) / sizeof(state->c[0]) / 2;
+	const uint32_t* const taps = (const uint32_t*)&state->taps[0];
+	uint32_t* const z = &state->z[0];
+	int16_t* const c = &state->c[0];
+	size_t z_index = state->z_index;
+	size_t c_index = state->c_index;
+	uint32_t s3_s2 = state->s3_s2;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+
+	int32_t n = sample_count;
+	for(; n>0; n-=4) {
+		const uint32_t s1_s0 = *(s++);						/* A[k]:B[k] */
+		const uint32_t a1_a0 = __PKHTB(s1_s0, s3_s2, 16);	/* 1: D[k-1] = A[k]:A[k-1] */
+		s3_s2 = *(s++);										/* A[k+1]:B[k+1] */
+		const uint32_t a2_a1 = __PKHTB(s3_s2, s1_s0, 16);	/* 1: D[k] = A[k+1]:A[k] */
+		const uint32_t b1_b0 = __PKHBT(s1_s0, s3_s2, 16);	/* 1: B[k+1]:B[k] */
+
+		z[z_index + 0] = z[z_index + 0 + z_count] = a1_a0;
+		z[z_index + 1] = z[z_index + 1 + z_count] = a2_a1;
+		z_index += 2;
+		if( z_index == z_count ) {
+			z_index = 0;
+		}
+
+		*(uint32_t*)&c[c_index] = *(uint32_t*)&c[c_index + c_count] = b1_b0;
+		const int16_t* const cp = &c[c_index + c_count - center_delay];
+		c_index += 2;
+		if( c_index == c_count ) {
+			c_index = 0;
+		}
+
+		int32_t y0 = (cp[0] << 14) + (1 << 14);		/* B[k-K] * 0.5 + rounding */
+		int32_t y1 = (cp[1] << 14) + (1 << 14);		/* B[k+1-K] * 0.5 + rounding */
+
+		const uint32_t* zl = &z[z_index];
+		const uint32_t* zh = &z[z_index + z_count - 1];
+		const uint32_t* tp = taps;
+		for(size_t j=0; j<taps_count; j+=2) {
+			const uint32_t t1_t0 = *(tp++);
+			const uint32_t p0 = __SHADD16(*(zh--), *(zl++));	/* 1: (D[k-p] + D[k-2K-1+p]) / 2 */
+			y0 = __SMLABB(p0, t1_t0, y0);						/* 1: y0 += lo * T0 */
+			y1 = __SMLATB(p0, t1_t0, y1);						/* 1: y1 += hi * T0 */
+			const uint32_t p1 = __SHADD16(*(zh--), *(zl++));	/* 1: next pair, p+1 */
+			y0 = __SMLABT(p1, t1_t0, y0);						/* 1: y0 += lo * T1 */
+			y1 = __SMLATT(p1, t1_t0, y1);						/* 1: y1 += hi * T1 */
+		}
+
+		y0 = __SSAT(y0 >> 15, 16);
+		y1 = __SSAT(y1 >> 15, 16);
+		*(d++) = __PKHBT(y0, y1, 16);						/* 1: Y1:Y0 */
+	}
+	state->z_index = z_index;
+	state->c_index = c_index;
+	state->s3_s2 = s3_s2;
+
+	return sample_count / 2;
+}
 
+void fir_hb_decim_2_cplx_s16_s16_init(
+	fir_hb_decim_2_cplx_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+) {
+	const size_t taps_max = sizeof(state->taps) / sizeof(state->taps[0]);
+	state->taps_count = fir_hb_fold_taps(state->taps, taps_max, taps, taps_count);
+	state->center_delay = (taps_count - 3) >> 2;
+	state->z_count = (taps_count + 1) >> 1;
+	state->z_index = 0;
+	state->c_index = 0;
+	for(size_t i=0; i<sizeof(state->z)/sizeof(state->z[0]); i++) {
+		state->z[i] = 0;
+	}
+	for(size_t i=0; i<sizeof(state->c)/sizeof(state->c[0]); i++) {
+		state->c[i] = 0;
+	}
+}
+
+size_t fir_hb_decim_2_cplx_s16_s16(
+	fir_hb_decim_2_cplx_s16_s16_state_t* const state,
+	complex_s16_t* src,
+	complex_s16_t* dst,
+	const size_t sample_count
+) {
+	/* complex<int16_t> input (sample count "n" must be multiple of 2)
+	 * -> complex<int16_t> output, decimated by 2. May run in place.
+	 *
+	 * Same arrangement as fir_hb_decim_2_real_s16_s16, one output per
+	 * iteration. Samples are Q:I words, so SHADD16 sums a symmetric pair
+	 * for I and Q at once, and each folded tap costs one MAC per component.
+	 */
+	const size_t taps_count = state->taps_count;
+	const size_t center_delay = state->center_delay;
+	const size_t z_count = state->z_count;
+	const size_t c_count = sizeof(state->c) / sizeof(state->c[0]) / 2;
+	const uint32_t* const taps = (const uint32_t*)&state->taps[0];
+	uint32_t* const z = &state->z[0];
+	uint32_t* const c = &state->c[0];
+	size_t z_index = state->z_index;
+	size_t c_index = state->c_index;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+
+	const uint32_t half = 1 << 14;
+
+	int32_t n = sample_count;
 	for(; n>0; n-=2) {
-		state->z[63] = *(src++);
-		state->z[64] = *(src++);
-
-		int64_t acc = 0;
-		uint32_t* z = (uint32_t*)&state->z[0];
-		uint32_t* t = (uint32_t*)&tap[0];
-		for(size_t j=0; j<63; j+=4) {
-			const uint32_t s10 = *(z++);
-			const uint32_t s32 = *(z++);
-			const uint32_t t10 = *(t++);
-			const uint32_t t32 = *(t++);
-			acc = __SMLALD(acc, s10, t10);
-			acc = __SMLALD(acc, s32, t32);
-			z[-2] = s32;
-			z[-1] = z[0];
+		const uint32_t b = *(s++);			/* B[k] */
+		const uint32_t a = *(s++);			/* A[k] */
+
+		z[z_index] = z[z_index + z_count] = a;
+		z_index += 1;
+		if( z_index == z_count ) {
+			z_index = 0;
+		}
+
+		c[c_index] = c[c_index + c_count] = b;
+		const uint32_t center = c[c_index + c_count - center_delay];
+		c_index += 1;
+		if( c_index == c_count ) {
+			c_index = 0;
 		}
-		*(dst++) = acc >> 16;
+
+		int32_t i = __SMLABB(center, half, half);	/* 1: I(B[k-K]) * 0.5 + rounding */
+		int32_t q = __SMLATB(center, half, half);	/* 1: Q(B[k-K]) * 0.5 + rounding */
+
+		const uint32_t* zl = &z[z_index];
+		const uint32_t* zh = &z[z_index + z_count - 1];
+		const uint32_t* tp = taps;
+		for(size_t j=0; j<taps_count; j+=2) {
+			const uint32_t t1_t0 = *(tp++);
+			const uint32_t p0 = __SHADD16(*(zh--), *(zl++));	/* 1: (A[k-p] + A[k-2K-1+p]) / 2 */
+			i = __SMLABB(p0, t1_t0, i);							/* 1: i += I * T0 */
+			q = __SMLATB(p0, t1_t0, q);							/* 1: q += Q * T0 */
+			const uint32_t p1 = __SHADD16(*(zh--), *(zl++));	/* 1: next pair, p+1 */
+			i = __SMLABT(p1, t1_t0, i);							/* 1: i += I * T1 */
+			q = __SMLATT(p1, t1_t0, q);							/* 1: q += Q * T1 */
+		}
+
+		i = __SSAT(i >> 15, 16);
+		q = __SSAT(q >> 15, 16);
+		*(d++) = __PKHBT(i, q, 16);							/* 1: Q:I */
 	}
+	state->z_index = z_index;
+	state->c_index = c_index;
+
+	return sample_count / 2;
+}
+
+void fir_sym_cplx_s16_s16_init(
+	fir_sym_cplx_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+) {
+	const size_t outer_count = taps_count >> 1;
+	const size_t taps_max = sizeof(state->taps) / sizeof(state->taps[0]);
+	for(size_t j=0; j<taps_max; j++) {
+		state->taps[j] = (j < outer_count) ? (taps[j] * 2) : 0;
+	}
+	state->taps_count = (outer_count + 1) & ~1;
+	state->center_tap = taps[outer_count];
+	state->z_count = taps_count;
+	state->z_index = 0;
+	for(size_t i=0; i<sizeof(state->z)/sizeof(state->z[0]); i++) {
+		state->z[i] = 0;
+	}
+}
+
+size_t fir_sym_cplx_s16_s16(
+	fir_sym_cplx_s16_s16_state_t* const state,
+	complex_s16_t* src,
+	complex_s16_t* dst,
+	const size_t sample_count
+) {
+	/* complex<int16_t> input
+	 * -> complex<int16_t> output, same rate. May run in place.
+	 *
+	 * y[n] = h[M] * x[n-M] + sum(p=0..M-1, h[p] * (x[n-p] + x[n-2M+p]))
+	 */
+	const size_t taps_count = state->taps_count;
+	const size_t z_count = state->z_count;
+	const size_t center_offset = z_count >> 1;
+	const uint32_t* const taps = (const uint32_t*)&state->taps[0];
+	const uint32_t center_tap = (uint16_t)state->center_tap;
+	uint32_t* const z = &state->z[0];
+	size_t z_index = state->z_index;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+
+	const uint32_t half = 1 << 14;
+
+	for(size_t n=sample_count; n>0; n--) {
+		const uint32_t x = *(s++);
+
+		z[z_index] = z[z_index + z_count] = x;
+		z_index += 1;
+		if( z_index == z_count ) {
+			z_index = 0;
+		}
+
+		const uint32_t* zl = &z[z_index];
+		const uint32_t* zh = &z[z_index + z_count - 1];
+		const uint32_t center = zl[center_offset];
+		int32_t i = __SMLABB(center, center_tap, half);	/* 1: I(x[n-M]) * h[M] + rounding */
+		int32_t q = __SMLATB(center, center_tap, half);	/* 1: Q(x[n-M]) * h[M] + rounding */
+
+		const uint32_t* tp = taps;
+		for(size_t j=0; j<taps_count; j+=2) {
+			const uint32_t t1_t0 = *(tp++);
+			const uint32_t p0 = __SHADD16(*(zh--), *(zl++));	/* 1: (x[n-p] + x[n-2M+p]) / 2 */
+			i = __SMLABB(p0, t1_t0, i);							/* 1: i += I * T0 */
+			q = __SMLATB(p0, t1_t0, q);							/* 1: q += Q * T0 */
+			const uint32_t p1 = __SHADD16(*(zh--), *(zl++));	/* 1: next pair, p+1 */
+			i = __SMLABT(p1, t1_t0, i);							/* 1: i += I * T1 */
+			q = __SMLATT(p1, t1_t0, q);							/* 1: q += Q * T1 */
+		}
+
+		i = __SSAT(i >> 15, 16);
+		q = __SSAT(q >> 15, 16);
+		*(d++) = __PKHBT(i, q, 16);							/* 1: Q:I */
+	}
+	state->z_index = z_index;
+
+	return sample_count;
 }
-*/
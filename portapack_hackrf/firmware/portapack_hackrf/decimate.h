@@ -26,6 +26,7 @@
 #include <stddef.h>
 
 #include "complex.h"
+#include "arm_intrinsics.h"
 
 typedef struct translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t {
 	uint32_t q1_i0;
@@ -76,6 +77,93 @@ size_t fir_cic3_decim_2_s16_s16(
 	const size_t sample_count
 );
 
+/* Output scaling for CIC stages with built-in gain adjustment. Flags may be
+ * combined.
+ */
+typedef enum cic_output_policy_t {
+	CIC_OUTPUT_TRUNCATE = 0,	/* Arithmetic shift (toward -inf), wrap on overflow */
+	CIC_OUTPUT_ROUND = 1,		/* Round to nearest before shifting */
+	CIC_OUTPUT_SATURATE = 2,	/* Saturate to int16 after shifting */
+	CIC_OUTPUT_ROUND_SATURATE = 3,
+} cic_output_policy_t;
+
+template<uint32_t Shift, uint32_t Policy>
+__attribute__((always_inline)) static inline uint32_t cic_output_scale(uint32_t value) {
+	int32_t t = value;
+	if( Policy & CIC_OUTPUT_ROUND ) {
+		t += (1 << Shift) >> 1;
+	}
+	t >>= Shift;
+	if( Policy & CIC_OUTPUT_SATURATE ) {
+		t = __SSAT(t, 16);
+	}
+	return t;
+}
+
+/* Complex non-recursive 3rd-order CIC filter (taps 1,3,3,1), decimate by 2.
+ * Same as fir_cic3_decim_2_s16_s16, but the 32-bit filter output is scaled
+ * by 2^-Shift (gain of 8 >> Shift) according to Policy before it is packed
+ * to int16, so no separate gain-adjustment pass over the buffer is needed.
+ */
+template<uint32_t Shift, uint32_t Policy>
+size_t fir_cic3_decim_2_s16_s16_shift(
+	fir_cic3_decim_2_s16_s16_state_t* const state,
+	complex_s16_t* const src,
+	complex_s16_t* const dst,
+	const size_t sample_count
+) {
+	/* Consumes 16 bytes (4 s16:s16 samples) per loop iteration,
+	 * Produces  8 bytes (2 s16:s16 samples) per loop iteration.
+	 */
+	int32_t n = sample_count;
+	uint32_t t1 = state->iq0;
+	uint32_t t2 = state->iq1;
+	uint32_t t3, t4;
+	uint32_t taps = 0x00000003;
+	uint32_t* s = (uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+	uint32_t i, q;
+	for(; n>0; n-=4) {
+		i = __SXTH(t1, 0);			/* 1: I0 */
+		q = __SXTH(t1, 16);			/* 1: Q0 */
+		i = __SMLABB(t2, taps, i);	/* 1: I1*3 + I0 */
+		q = __SMLATB(t2, taps, q);	/* 1: Q1*3 + Q0 */
+
+		t3 = *(s++);				/* 3: Q2:I2 */
+		t4 = *(s++);				/*    Q3:I3 */
+
+		i = __SMLABB(t3, taps, i);	/* 1: I2*3 + I1*3 + I0 */
+		q = __SMLATB(t3, taps, q);	/* 1: Q2*3 + Q1*3 + Q0 */
+		i = __SXTAH(i, t4, 0);		/* 1: I3 + Q2*3 + Q1*3 + Q0 */
+		q = __SXTAH(q, t4, 16);		/* 1: Q3 + Q2*3 + Q1*3 + Q0 */
+		i = cic_output_scale<Shift, Policy>(i);
+		q = cic_output_scale<Shift, Policy>(q);
+		i = __BFI(i, q, 16, 16);	/* 1: D2_Q0:D2_I0 */
+		*(d++) = i;					/* D2_Q0:D2_I0 */
+
+		i = __SXTH(t3, 0);			/* 1: I2 */
+		q = __SXTH(t3, 16);			/* 1: Q2 */
+		i = __SMLABB(t4, taps, i);	/* 1: I3*3 + I2 */
+		q = __SMLATB(t4, taps, q);	/* 1: Q3*3 + Q2 */
+
+		t1 = *(s++);				/* 3: Q4:I4 */
+		t2 = *(s++);				/*    Q5:I5 */
+
+		i = __SMLABB(t1, taps, i);	/* 1: I4*3 + I3*3 + I2 */
+		q = __SMLATB(t1, taps, q);	/* 1: Q4*3 + Q3*3 + Q2 */
+		i = __SXTAH(i, t2, 0);		/* 1: I5 + Q4*3 + Q3*3 + Q2 */
+		q = __SXTAH(q, t2, 16);		/* 1: Q5 + Q4*3 + Q3*3 + Q2 */
+		i = cic_output_scale<Shift, Policy>(i);
+		q = cic_output_scale<Shift, Policy>(q);
+		i = __BFI(i, q, 16, 16);	/* 1: D2_Q1:D2_I1 */
+		*(d++) = i;					/* D2_Q1:D2_I1 */
+	}
+	state->iq0 = t1;
+	state->iq1 = t2;
+
+	return sample_count / 2;
+}
+
 typedef struct fir_cic4_decim_2_real_s16_s16_state_t {
 	int16_t z[7];
 } fir_cic4_decim_2_real_s16_s16_state_t;
@@ -91,7 +179,11 @@ size_t fir_cic4_decim_2_real_s16_s16(
 typedef struct fir_64_decim_2_real_s16_s16_state_t {
 	const int16_t* taps;
 	size_t taps_count;
-	int16_t z[66];
+	size_t z_index;
+	/* Circular delay line, each sample pair written twice (at z_index and
+	 * z_index + taps_count) so the filter window is always contiguous.
+	 */
+	int16_t z[128];
 } fir_64_decim_2_real_s16_s16_state_t;
 
 void fir_64_decim_2_real_s16_s16_init(
@@ -110,7 +202,12 @@ size_t fir_64_decim_2_real_s16_s16(
 typedef struct fir_64_decim_8_cplx_s16_s16_state_t {
 	const int16_t* taps;
 	size_t taps_count;
-	complex_s16_t z[72];
+	size_t z_index;
+	/* Circular delay line, split into I and Q planes, each sample written
+	 * twice (at z_index and z_index + taps_count).
+	 */
+	int16_t z_i[128];
+	int16_t z_q[128];
 } fir_64_decim_8_cplx_s16_s16_state_t;
 
 void fir_64_decim_8_cplx_s16_s16_init(
@@ -126,4 +223,100 @@ size_t fir_64_decim_8_cplx_s16_s16(
 	const size_t sample_count
 );
 
+/* Half-band FIR, decimate by 2.
+ *
+ * taps is the full symmetric half-band filter (4k+3 taps, up to 47),
+ * normalized to 1 << 15 == 1.0: centre tap 16384, every other tap zero.
+ * Only the non-zero outer taps are kept, folded so that each symmetric pair
+ * of samples is summed (SHADD16, halved to avoid overflow) and multiplied
+ * once by a doubled coefficient. The centre tap is a plain shift. Output
+ * gain is 1.0, with at most about 1 LSB of error from the halving.
+ */
+typedef struct fir_hb_decim_2_real_s16_s16_state_t {
+	size_t taps_count;
+	size_t center_delay;
+	size_t z_count;
+	size_t z_index;
+	size_t c_index;
+	uint32_t s3_s2;
+	int16_t taps[12];
+	/* Circular delay lines, written twice (at index and index + count) so
+	 * the window is always contiguous. z holds overlapping pairs of the
+	 * odd-phase samples, c holds the even-phase (centre tap) samples.
+	 */
+	uint32_t z[48];
+	int16_t c[28];
+} fir_hb_decim_2_real_s16_s16_state_t;
+
+void fir_hb_decim_2_real_s16_s16_init(
+	fir_hb_decim_2_real_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+);
+
+size_t fir_hb_decim_2_real_s16_s16(
+	fir_hb_decim_2_real_s16_s16_state_t* const state,
+	int16_t* src,
+	int16_t* dst,
+	const size_t sample_count
+);
+
+typedef struct fir_hb_decim_2_cplx_s16_s16_state_t {
+	size_t taps_count;
+	size_t center_delay;
+	size_t z_count;
+	size_t z_index;
+	size_t c_index;
+	int16_t taps[12];
+	/* Circular delay lines, as for fir_hb_decim_2_real_s16_s16. */
+	uint32_t z[48];
+	uint32_t c[24];
+} fir_hb_decim_2_cplx_s16_s16_state_t;
+
+void fir_hb_decim_2_cplx_s16_s16_init(
+	fir_hb_decim_2_cplx_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+);
+
+size_t fir_hb_decim_2_cplx_s16_s16(
+	fir_hb_decim_2_cplx_s16_s16_state_t* const state,
+	complex_s16_t* src,
+	complex_s16_t* dst,
+	const size_t sample_count
+);
+
+/* Symmetric (linear phase) complex FIR, no decimation.
+ *
+ * taps is the full filter (odd count, up to 31), normalized to
+ * 1 << 15 == 1.0. As with the half-band decimators, symmetric sample pairs
+ * are summed (SHADD16) and multiplied once by a doubled coefficient, so each
+ * output costs (taps_count + 1) / 2 MACs per component. Sum of absolute tap
+ * values must be below 2.0.
+ */
+typedef struct fir_sym_cplx_s16_s16_state_t {
+	size_t taps_count;
+	size_t z_count;
+	size_t z_index;
+	int16_t taps[16];
+	int16_t center_tap;
+	/* Circular delay line, each sample written twice (at z_index and
+	 * z_index + z_count).
+	 */
+	uint32_t z[62];
+} fir_sym_cplx_s16_s16_state_t;
+
+void fir_sym_cplx_s16_s16_init(
+	fir_sym_cplx_s16_s16_state_t* const state,
+	const int16_t* const taps,
+	const size_t taps_count
+);
+
+size_t fir_sym_cplx_s16_s16(
+	fir_sym_cplx_s16_s16_state_t* const state,
+	complex_s16_t* src,
+	complex_s16_t* dst,
+	const size_t sample_count
+);
+
 #endif/*__DECIMATE_H__*/
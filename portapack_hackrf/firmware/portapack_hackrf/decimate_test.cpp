@@ -22,6 +22,7 @@
 #include <stdint.h>
 
 #include "decimate.h"
+#include "filters.h"
 
 #include <string.h>
 
@@ -130,6 +131,126 @@ static int test_fir_cic3_decim_2_s16_s16() {
 	return results_match(&data, &expected_result, sizeof(expected_result));
 }
 
+static int test_fir_64_decim_2_real_s16_s16() {
+	int16_t data[] = {
+		  9174,  -1458,  -1303,   1188,    -89,   7125,   -606,   8009,
+		 -3175,  -8058,   1105,  -7494,   -476,  -5064,   5524,   5556,
+		  2285,  -3589,   3969,    567,  -6539,   -710,  -2167,     86,
+		 -1040,   8482,  -1073,   3441,  -3186,   9702,   8857,   -292,
+		 -1756,   1274,  -5384,  -8125,  -1602,   4011,  -6396,   5223,
+		  9674,   4709,  -8551,   -803,  -6635,  -9306,  -1526,   5650,
+		   826,  -7558,    -62,   4287,   5454,   7771,  -5627,  -5587,
+		  9973,   7021,   7854,    507,   6722,   6710,  -9785,  -5035,
+		  1705,  -1448,    561,  -9898,  -3717,   4165,   9047,   -322,
+		  2594,  -9505,   8875,   5960,  -5090,   1069,   5330,   5737,
+		  7233,  -1012,     23,   2686,  -3242,   8117,  -9181,  -3269,
+		  5137,   8673,   7238,   1859,   9103,  -8827,  -9456,    807,
+	};
+
+	fir_64_decim_2_real_s16_s16_state_t state;
+	fir_64_decim_2_real_s16_s16_init(&state, taps_64_lp_156_198, 64);
+	fir_64_decim_2_real_s16_s16(&state, &data[ 0], &data[ 0], 8);
+	fir_64_decim_2_real_s16_s16(&state, &data[ 8], &data[ 4], 36);
+	fir_64_decim_2_real_s16_s16(&state, &data[44], &data[22], 52);
+
+	const int16_t expected_result[] = {
+		     0,     -3,     11,    -22,     39,     26,    -95,     77,
+		   -12,   -122,    206,   -118,   -165,    477,   -494,    -78,
+		  2662,   1496,    -72,   3458,   2794,  -4029,  -4739,    357,
+		  2941,   1933,  -1649,  -3003,    628,   2032,   2097,   4917,
+		  3449,  -2416,  -5117,  -1556,   5196,   2766,  -6178,  -4320,
+		  -101,  -1130,   2736,   2943,   -319,   6076,   7464,   -854,
+	};
+
+	return results_match(&data, &expected_result, sizeof(expected_result));
+}
+
+static int test_fir_hb_decim_2_real_s16_s16() {
+	int16_t data[] = {
+		  9174,  -1458,  -1303,   1188,    -89,   7125,   -606,   8009,
+		 -3175,  -8058,   1105,  -7494,   -476,  -5064,   5524,   5556,
+		  2285,  -3589,   3969,    567,  -6539,   -710,  -2167,     86,
+		 -1040,   8482,  -1073,   3441,  -3186,   9702,   8857,   -292,
+		 -1756,   1274,  -5384,  -8125,  -1602,   4011,  -6396,   5223,
+		  9674,   4709,  -8551,   -803,  -6635,  -9306,  -1526,   5650,
+		   826,  -7558,    -62,   4287,   5454,   7771,  -5627,  -5587,
+		  9973,   7021,   7854,    507,   6722,   6710,  -9785,  -5035,
+		  1705,  -1448,    561,  -9898,  -3717,   4165,   9047,   -322,
+		  2594,  -9505,   8875,   5960,  -5090,   1069,   5330,   5737,
+		  7233,  -1012,     23,   2686,  -3242,   8117,  -9181,  -3269,
+		  5137,   8673,   7238,   1859,   9103,  -8827,  -9456,    807,
+	};
+
+	fir_hb_decim_2_real_s16_s16_state_t state;
+	fir_hb_decim_2_real_s16_s16_init(&state, taps_23_hb, 23);
+	fir_hb_decim_2_real_s16_s16(&state, &data[ 0], &data[ 0], 8);
+	fir_hb_decim_2_real_s16_s16(&state, &data[ 8], &data[ 4], 36);
+	fir_hb_decim_2_real_s16_s16(&state, &data[44], &data[22], 52);
+
+	const int16_t expected_result[] = {
+		     2,    -10,     24,    -45,    113,   4133,   -963,   1739,
+		  4809,  -1811,  -4036,  -3887,   3524,   2054,    349,  -2401,
+		 -2373,   2432,   2163,   2004,   6912,   -619,  -4662,  -2692,
+		   263,   6793,  -2025,  -7631,  -1027,    620,  -2926,   8349,
+		 -3707,   5378,   6127,   5254,  -4326,   -917,  -2706,  -4277,
+		  7777,  -3143,   3837,   -184,   3957,   5562,  -1071,   2646,
+	};
+
+	return results_match(&data, &expected_result, sizeof(expected_result));
+}
+
+static int test_fir_hb_decim_2_cplx_s16_s16() {
+	complex_s16_t data[] = {
+		{  9174,   807 }, { -1458, -9456 }, { -1303, -8827 }, {  1188,  9103 },
+		{   -89,  1859 }, {  7125,  7238 }, {  -606,  8673 }, {  8009,  5137 },
+		{ -3175, -3269 }, { -8058, -9181 }, {  1105,  8117 }, { -7494, -3242 },
+		{  -476,  2686 }, { -5064,    23 }, {  5524, -1012 }, {  5556,  7233 },
+		{  2285,  5737 }, { -3589,  5330 }, {  3969,  1069 }, {   567, -5090 },
+		{ -6539,  5960 }, {  -710,  8875 }, { -2167, -9505 }, {    86,  2594 },
+		{ -1040,  -322 }, {  8482,  9047 }, { -1073,  4165 }, {  3441, -3717 },
+		{ -3186, -9898 }, {  9702,   561 }, {  8857, -1448 }, {  -292,  1705 },
+		{ -1756, -5035 }, {  1274, -9785 }, { -5384,  6710 }, { -8125,  6722 },
+		{ -1602,   507 }, {  4011,  7854 }, { -6396,  7021 }, {  5223,  9973 },
+		{  9674, -5587 }, {  4709, -5627 }, { -8551,  7771 }, {  -803,  5454 },
+		{ -6635,  4287 }, { -9306,   -62 }, { -1526, -7558 }, {  5650,   826 },
+		{   826,  5650 }, { -7558, -1526 }, {   -62, -9306 }, {  4287, -6635 },
+		{  5454,  -803 }, {  7771, -8551 }, { -5627,  4709 }, { -5587,  9674 },
+		{  9973,  5223 }, {  7021, -6396 }, {  7854,  4011 }, {   507, -1602 },
+		{  6722, -8125 }, {  6710, -5384 }, { -9785,  1274 }, { -5035, -1756 },
+		{  1705,  -292 }, { -1448,  8857 }, {   561,  9702 }, { -9898, -3186 },
+		{ -3717,  3441 }, {  4165, -1073 }, {  9047,  8482 }, {  -322, -1040 },
+		{  2594,    86 }, { -9505, -2167 }, {  8875,  -710 }, {  5960, -6539 },
+		{ -5090,   567 }, {  1069,  3969 }, {  5330, -3589 }, {  5737,  2285 },
+		{  7233,  5556 }, { -1012,  5524 }, {    23, -5064 }, {  2686,  -476 },
+		{ -3242, -7494 }, {  8117,  1105 }, { -9181, -8058 }, { -3269, -3175 },
+		{  5137,  8009 }, {  8673,  -606 }, {  7238,  7125 }, {  1859,   -89 },
+		{  9103,  1188 }, { -8827, -1303 }, { -9456, -1458 }, {   807,  9174 },
+	};
+
+	fir_hb_decim_2_cplx_s16_s16_state_t state;
+	fir_hb_decim_2_cplx_s16_s16_init(&state, taps_47_hb, 47);
+	fir_hb_decim_2_cplx_s16_s16(&state, &data[ 0], &data[ 0],  8);
+	fir_hb_decim_2_cplx_s16_s16(&state, &data[ 8], &data[ 4], 34);
+	fir_hb_decim_2_cplx_s16_s16(&state, &data[42], &data[21], 54);
+
+	const complex_s16_t expected_result[] = {
+		{     0,     3 }, {    -2,   -11 }, {     2,    25 }, {    -4,   -48 },
+		{     9,    87 }, {   -17,  -145 }, {    30,   230 }, {   -53,  -355 },
+		{    90,   543 }, {  -150,  -849 }, {   260,  1456 }, {  3945, -3467 },
+		{  -738, -4717 }, {  1494,  6154 }, {  5047,  7515 }, { -1999, -2406 },
+		{ -3943,  -626 }, { -3850,  1671 }, {  3326,   114 }, {  2414,  8299 },
+		{  -155, -1400 }, { -1809,  4397 }, { -2990, -1518 }, {  3012,  2355 },
+		{  1699,  4767 }, {  2295, -8190 }, {  6831,  2559 }, {  -763, -6629 },
+		{ -4303,  2795 }, { -3231,  4089 }, {   907,  9016 }, {  6154, -2256 },
+		{ -1513,  3053 }, { -7905,  4650 }, { -1061, -4371 }, {   969,  3075 },
+		{ -3536, -6206 }, {  9102, -5971 }, { -4471,  3606 }, {  6033,  4526 },
+		{  5690, -1832 }, {  5412, -4043 }, { -4186, -3434 }, { -1323,  3505 },
+		{ -2108,  6115 }, { -4982,   104 }, {  8480,  3863 }, { -3732,  -276 },
+	};
+
+	return results_match(&data, &expected_result, sizeof(expected_result));
+}
+
 static void halt_if_failed(const int test_result) {
 	if( !test_result ) {
 		while(1);
@@ -140,4 +261,7 @@ void decimate_test() {
 	halt_if_failed(test_translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16());
 	halt_if_failed(test_fir_cic3_decim_2_s16_s32());
 	halt_if_failed(test_fir_cic3_decim_2_s16_s16());
+	halt_if_failed(test_fir_64_decim_2_real_s16_s16());
+	halt_if_failed(test_fir_hb_decim_2_real_s16_s16());
+	halt_if_failed(test_fir_hb_decim_2_cplx_s16_s16());
 }
\ No newline at end of file
@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __DECIMATION_CHAIN_H__
+#define __DECIMATION_CHAIN_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <type_traits>
+
+#include "complex.h"
+#include "decimate.h"
+#include "nco.h"
+
+/* Compile-time decimation chain.
+ *
+ * A stage describes its sample types, ratio and gain, and wraps a kernel
+ * from decimate.h:
+ *
+ *	typedef ... input_t;
+ *	typedef ... output_t;
+ *	typedef ... state_t;
+ *	static constexpr size_t ratio;
+ *	static constexpr uint32_t gain;
+ *	static constexpr bool in_place_only;
+ *	static void init(state_t& state);
+ *	static size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count);
+ *
+ * Stages must be able to run in place (dst == src), which holds for any
+ * stage that doesn't grow the data. The chain runs the block in chunks
+ * through all stages in place, and only the last stage writes to dst.
+ *
+ * Example:
+ *	typedef decimation_chain<
+ *		translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage,
+ *		fir_cic3_decim_2_s16_s16_stage<1>,
+ *		fir_cic3_decim_2_s16_s16_stage<0>
+ *	> bb_dec_t;
+ *
+ *	bb_dec_t::state_t state;
+ *	bb_dec_t::init(state);
+ *	n = bb_dec_t::execute(state, in, out, n);
+ *	static_assert(bb_dec_t::output_rate(2457600) == 307200, "");
+ */
+
+struct translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage {
+	typedef complex_s8_t input_t;
+	typedef complex_s16_t output_t;
+	typedef translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t state_t;
+	static constexpr size_t ratio = 2;
+	static constexpr uint32_t gain = 8;
+	static constexpr bool in_place_only = true;
+
+	static void init(state_t& state) {
+		translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		(void)dst;
+		return translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state, src, sample_count);
+	}
+};
+
+template<uint32_t Shift, uint32_t Policy = CIC_OUTPUT_ROUND_SATURATE>
+struct fir_cic3_decim_2_s16_s16_stage {
+	typedef complex_s16_t input_t;
+	typedef complex_s16_t output_t;
+	typedef fir_cic3_decim_2_s16_s16_state_t state_t;
+	static constexpr size_t ratio = 2;
+	static constexpr uint32_t gain = 8 >> Shift;
+	static constexpr bool in_place_only = false;
+
+	static void init(state_t& state) {
+		fir_cic3_decim_2_s16_s16_init(&state);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		return fir_cic3_decim_2_s16_s16_shift<Shift, Policy>(&state, src, dst, sample_count);
+	}
+};
+
+/* Fine tuning mixer, no decimation. The phase increment is read from
+ * *PhaseIncrement at every chunk, so whoever owns the tuning can change it
+ * without knowing where the chain's state lives.
+ */
+template<const volatile uint32_t* PhaseIncrement>
+struct nco_cplx_s16_s16_stage {
+	typedef complex_s16_t input_t;
+	typedef complex_s16_t output_t;
+	typedef nco_cplx_s16_s16_state_t state_t;
+	static constexpr size_t ratio = 1;
+	static constexpr uint32_t gain = 1;
+	static constexpr bool in_place_only = false;
+
+	static void init(state_t& state) {
+		nco_cplx_s16_s16_init(&state, 0, 1);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		state.phase_increment = *PhaseIncrement;
+		return nco_cplx_s16_s16(&state, src, dst, sample_count);
+	}
+};
+
+/* Half-band stages, e.g. fir_hb_decim_2_cplx_s16_s16_stage<taps_23_hb, 23>. */
+template<const int16_t* Taps, size_t TapsCount>
+struct fir_hb_decim_2_cplx_s16_s16_stage {
+	static_assert((TapsCount & 3) == 3 && TapsCount <= 47, "half-band filter must have 4k+3 taps, at most 47");
+
+	typedef complex_s16_t input_t;
+	typedef complex_s16_t output_t;
+	typedef fir_hb_decim_2_cplx_s16_s16_state_t state_t;
+	static constexpr size_t ratio = 2;
+	static constexpr uint32_t gain = 1;
+	static constexpr bool in_place_only = false;
+
+	static void init(state_t& state) {
+		fir_hb_decim_2_cplx_s16_s16_init(&state, Taps, TapsCount);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		return fir_hb_decim_2_cplx_s16_s16(&state, src, dst, sample_count);
+	}
+};
+
+template<const int16_t* Taps, size_t TapsCount>
+struct fir_hb_decim_2_real_s16_s16_stage {
+	static_assert((TapsCount & 3) == 3 && TapsCount <= 47, "half-band filter must have 4k+3 taps, at most 47");
+
+	typedef int16_t input_t;
+	typedef int16_t output_t;
+	typedef fir_hb_decim_2_real_s16_s16_state_t state_t;
+	static constexpr size_t ratio = 2;
+	static constexpr uint32_t gain = 1;
+	static constexpr bool in_place_only = false;
+
+	static void init(state_t& state) {
+		fir_hb_decim_2_real_s16_s16_init(&state, Taps, TapsCount);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		return fir_hb_decim_2_real_s16_s16(&state, src, dst, sample_count);
+	}
+};
+
+template<typename... Stages>
+struct decimation_chain_stages;
+
+template<typename Last>
+struct decimation_chain_stages<Last> {
+	static_assert(!Last::in_place_only, "last stage of a decimation chain must write to a separate output");
+
+	typedef typename Last::input_t input_t;
+	typedef typename Last::output_t output_t;
+	static constexpr size_t ratio = Last::ratio;
+	static constexpr uint32_t gain = Last::gain;
+
+	struct state_t {
+		typename Last::state_t stage;
+	};
+
+	static void init(state_t& state) {
+		Last::init(state.stage);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		return Last::execute(state.stage, src, dst, sample_count);
+	}
+};
+
+template<typename First, typename... Rest>
+struct decimation_chain_stages<First, Rest...> {
+	typedef decimation_chain_stages<Rest...> rest_t;
+
+	static_assert(std::is_same<typename First::output_t, typename rest_t::input_t>::value, "decimation chain stage sample types don't match");
+	static_assert(sizeof(typename First::output_t) <= sizeof(typename First::input_t) * First::ratio, "decimation chain stage can't run in place");
+
+	typedef typename First::input_t input_t;
+	typedef typename rest_t::output_t output_t;
+	static constexpr size_t ratio = First::ratio * rest_t::ratio;
+	static constexpr uint32_t gain = First::gain * rest_t::gain;
+
+	struct state_t {
+		typename First::state_t stage;
+		typename rest_t::state_t rest;
+	};
+
+	static void init(state_t& state) {
+		First::init(state.stage);
+		rest_t::init(state.rest);
+	}
+
+	__attribute__((always_inline)) static inline size_t execute(state_t& state, input_t* src, output_t* dst, size_t sample_count) {
+		typename First::output_t* const stage_out = (typename First::output_t*)src;
+		sample_count = First::execute(state.stage, src, stage_out, sample_count);
+		return rest_t::execute(state.rest, stage_out, dst, sample_count);
+	}
+};
+
+template<typename... Stages>
+struct decimation_chain {
+	typedef decimation_chain_stages<Stages...> stages_t;
+
+	typedef typename stages_t::input_t input_t;
+	typedef typename stages_t::output_t output_t;
+	typedef typename stages_t::state_t state_t;
+
+	static constexpr size_t ratio = stages_t::ratio;
+	static constexpr uint32_t gain = stages_t::gain;
+	static constexpr size_t state_size = sizeof(state_t);
+
+	/* Chunk size (input samples) is chosen so that every stage sees a
+	 * multiple of four samples, which the kernels require.
+	 */
+	static constexpr size_t chunk_size = (ratio * 2 > 128) ? (ratio * 2) : 128;
+
+	static constexpr uint32_t output_rate(const uint32_t input_rate) {
+		return input_rate / ratio;
+	}
+
+	static void init(state_t& state) {
+		stages_t::init(state);
+	}
+
+	/* sample_count must be a multiple of chunk_size. src is overwritten. */
+	static size_t execute(state_t& state, input_t* const src, output_t* const dst, const size_t sample_count) {
+		output_t* out = dst;
+		for(size_t n=0; n<sample_count; n+=chunk_size) {
+			out += stages_t::execute(state, &src[n], out, chunk_size);
+		}
+		return out - dst;
+	}
+};
+
+#endif/*__DECIMATION_CHAIN_H__*/
@@ -29,22 +29,168 @@
 
 #include "complex.h"
 #include "fxpt_atan2.h"
+#include "arm_intrinsics.h"
  
-void am_demodulate_s16_s16(complex_s16_t* src, uint16_t* dst, int32_t n) {
-	/* Maximum output: 46340 (when input is -32768,-32768) */
-	for(; n>0; n-=1) {
-		const complex_s16_t s = *(src++);
-		const uint32_t t = s.i * s.i + s.q * s.q;
-		*(dst++) = sqrtf((float)t);
+/* Square root table, sqrt(n << 24), n = 64..256. */
+static const uint32_t am_sqrt[193] = {
+	 32768,  33023,  33276,  33527,  33776,  34024,  34270,  34514,
+	 34756,  34996,  35235,  35472,  35708,  35942,  36175,  36406,
+	 36636,  36864,  37091,  37316,  37540,  37763,  37985,  38205,
+	 38424,  38642,  38858,  39073,  39287,  39500,  39712,  39923,
+	 40132,  40341,  40548,  40755,  40960,  41164,  41368,  41570,
+	 41771,  41972,  42171,  42369,  42567,  42763,  42959,  43154,
+	 43348,  43541,  43733,  43925,  44115,  44305,  44494,  44682,
+	 44869,  45056,  45242,  45427,  45611,  45795,  45977,  46160,
+	 46341,  46522,  46702,  46881,  47059,  47237,  47415,  47591,
+	 47767,  47942,  48117,  48291,  48465,  48637,  48809,  48981,
+	 49152,  49322,  49492,  49661,  49830,  49998,  50166,  50332,
+	 50499,  50665,  50830,  50995,  51159,  51323,  51486,  51649,
+	 51811,  51972,  52134,  52294,  52454,  52614,  52773,  52932,
+	 53090,  53248,  53405,  53562,  53719,  53874,  54030,  54185,
+	 54340,  54494,  54647,  54801,  54954,  55106,  55258,  55410,
+	 55561,  55712,  55862,  56012,  56162,  56311,  56459,  56608,
+	 56756,  56903,  57051,  57198,  57344,  57490,  57636,  57781,
+	 57926,  58071,  58215,  58359,  58503,  58646,  58789,  58931,
+	 59073,  59215,  59357,  59498,  59639,  59779,  59919,  60059,
+	 60199,  60338,  60477,  60615,  60753,  60891,  61029,  61166,
+	 61303,  61440,  61576,  61712,  61848,  61984,  62119,  62254,
+	 62388,  62523,  62657,  62790,  62924,  63057,  63190,  63323,
+	 63455,  63587,  63719,  63850,  63982,  64113,  64243,  64374,
+	 64504,  64634,  64763,  64893,  65022,  65151,  65279,  65408,
+	 65536,
+};
+
+/* Magnitude of one Q:I sample, up to 46341. */
+template<am_magnitude_t Magnitude>
+__attribute__((always_inline)) static inline uint32_t am_magnitude(const uint32_t q_i) {
+	if( Magnitude == AM_MAGNITUDE_EXACT ) {
+		/* Normalize I^2+Q^2 by an even shift to [2^30, 2^32), take the
+		 * square root from the top bits by table interpolation, then undo
+		 * half the shift.
+		 */
+		const uint32_t t = __SMUAD(q_i, q_i);		/* 1: I^2 + Q^2, as unsigned */
+		if( t == 0 ) {
+			return 0;
+		}
+		const uint32_t shift = __CLZ(t) & ~1;
+		const uint32_t m = t << shift;
+		const uint32_t n = (m >> 24) - 64;
+		const uint32_t f = (m >> 16) & 0xff;
+		const uint32_t r = am_sqrt[n] + (((am_sqrt[n + 1] - am_sqrt[n]) * f) >> 8);
+		return (r + (1 << (shift >> 1) >> 1)) >> (shift >> 1);
+	} else {
+		const int32_t i = __SXTH(q_i, 0);
+		const int32_t q = __SXTH(q_i, 16);
+		const uint32_t ai = (i < 0) ? -i : i;
+		const uint32_t aq = (q < 0) ? -q : q;
+		const uint32_t mx = (ai > aq) ? ai : aq;
+		const uint32_t mn = (ai > aq) ? aq : ai;
+		if( Magnitude == AM_MAGNITUDE_FAST ) {
+			/* alpha = 15/16, beta = 15/32 */
+			return mx - (mx >> 4) + (mn >> 1) - (mn >> 5);
+		} else {
+			/* max(max + min/8, 27/32 max + 9/16 min) */
+			const uint32_t m0 = mx + (mn >> 3);
+			const uint32_t m1 = mx - (mx >> 3) - (mx >> 5) + (mn >> 1) + (mn >> 4);
+			return (m0 > m1) ? m0 : m1;
+		}
 	}
 }
- 
-void am_demodulate_s16_f32(complex_s16_t* src, float* dst, int32_t n) {
-	/* Maximum output: 46340.951 (when input is -32768,-32768) */
+
+template<am_magnitude_t Magnitude>
+static void am_demodulate_s16_s16_loop(complex_s16_t* src, uint16_t* dst, int32_t n) {
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+	for(; n>0; n-=2) {
+		const uint32_t m0 = am_magnitude<Magnitude>(*(s++));
+		const uint32_t m1 = am_magnitude<Magnitude>(*(s++));
+		*(d++) = m0 | (m1 << 16);
+	}
+}
+
+template<am_magnitude_t Magnitude>
+static void am_demodulate_hpf_s16_s16_loop(am_demodulate_hpf_s16_s16_state_t* const state, complex_s16_t* src, int16_t* dst, int32_t n) {
+	const uint32_t hpf_shift = state->hpf_shift;
+	int32_t dc = state->dc;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+	for(; n>0; n-=2) {
+		const int32_t m0 = am_magnitude<Magnitude>(*(s++));
+		const int32_t m1 = am_magnitude<Magnitude>(*(s++));
+		const int32_t y0 = __SSAT(m0 - (dc >> 15), 16);
+		dc += ((m0 << 15) - dc) >> hpf_shift;
+		const int32_t y1 = __SSAT(m1 - (dc >> 15), 16);
+		dc += ((m1 << 15) - dc) >> hpf_shift;
+		*(d++) = __PKHBT(y0, y1, 16);
+	}
+	state->dc = dc;
+}
+
+void am_demodulate_s16_s16(complex_s16_t* src, uint16_t* dst, int32_t n, const am_magnitude_t magnitude) {
+	/* Maximum output: 46341 (when input is -32768,-32768) */
+	switch(magnitude) {
+	case AM_MAGNITUDE_FAST:		am_demodulate_s16_s16_loop<AM_MAGNITUDE_FAST>(src, dst, n); break;
+	case AM_MAGNITUDE_BETTER:	am_demodulate_s16_s16_loop<AM_MAGNITUDE_BETTER>(src, dst, n); break;
+	default:					am_demodulate_s16_s16_loop<AM_MAGNITUDE_EXACT>(src, dst, n); break;
+	}
+}
+
+void am_envelope_normalize_u16_s16_init(
+	am_envelope_normalize_u16_s16_state_t* const state,
+	const float rise_factor,
+	const float fall_factor
+) {
+	state->envelope = 0;
+	state->rise = (int32_t)(rise_factor * 32768.0f);
+	state->fall = (int32_t)(fall_factor * 32768.0f);
+}
+
+void am_envelope_normalize_u16_s16(
+	am_envelope_normalize_u16_s16_state_t* const state,
+	const uint16_t* src,
+	int16_t* dst,
+	int32_t n
+) {
+	/* Magnitude is at most 46341, so the Q4 difference times a Q15 factor
+	 * below 0.09 stays within int32.
+	 */
+	const int32_t rise = state->rise;
+	const int32_t fall = state->fall;
+	int32_t envelope = state->envelope;
 	for(; n>0; n-=1) {
-		const complex_s16_t s = *(src++);
-		const uint32_t t = s.i * s.i + s.q * s.q;
-		*(dst++) = sqrtf((float)t);
+		const int32_t m = *(src++);
+		const int32_t difference = (m << 4) - envelope;
+		envelope += (difference * ((difference > 0) ? rise : fall)) >> 15;
+
+		/* m / envelope in Q13 is (m << 13) / envelope; twice that, less
+		 * 1.0. The + 1 keeps the division defined with no signal.
+		 */
+		const uint32_t ratio = ((uint32_t)m << 14) / ((uint32_t)(envelope >> 4) + 1);
+		*(dst++) = __SSAT((int32_t)ratio - 8192, 16);
+	}
+	state->envelope = envelope;
+}
+
+void am_demodulate_hpf_s16_s16_init(
+	am_demodulate_hpf_s16_s16_state_t* const state,
+	const am_magnitude_t magnitude,
+	const uint32_t hpf_shift
+) {
+	state->dc = 0;
+	state->hpf_shift = hpf_shift;
+	state->magnitude = magnitude;
+}
+
+void am_demodulate_hpf_s16_s16(
+	am_demodulate_hpf_s16_s16_state_t* const state,
+	complex_s16_t* src,
+	int16_t* dst,
+	int32_t n
+) {
+	switch(state->magnitude) {
+	case AM_MAGNITUDE_FAST:		am_demodulate_hpf_s16_s16_loop<AM_MAGNITUDE_FAST>(state, src, dst, n); break;
+	case AM_MAGNITUDE_BETTER:	am_demodulate_hpf_s16_s16_loop<AM_MAGNITUDE_BETTER>(state, src, dst, n); break;
+	default:					am_demodulate_hpf_s16_s16_loop<AM_MAGNITUDE_EXACT>(state, src, dst, n); break;
 	}
 }
 
@@ -73,9 +219,127 @@ void fm_demodulate_s32_s32(
 	state->z1 = z1;
 }
 
+/* Reciprocal table, 2^31 / (32768 + 128 * n), n = 0..256. */
+static const uint32_t fm_reciprocal[257] = {
+	 65536,  65281,  65028,  64777,  64528,  64281,  64035,  63792,
+	 63550,  63310,  63072,  62836,  62602,  62369,  62138,  61909,
+	 61681,  61455,  61231,  61008,  60787,  60568,  60350,  60133,
+	 59919,  59705,  59494,  59283,  59075,  58867,  58662,  58457,
+	 58254,  58053,  57852,  57654,  57456,  57260,  57065,  56872,
+	 56680,  56489,  56299,  56111,  55924,  55738,  55554,  55370,
+	 55188,  55007,  54828,  54649,  54471,  54295,  54120,  53946,
+	 53773,  53601,  53431,  53261,  53092,  52925,  52759,  52593,
+	 52429,  52265,  52103,  51942,  51782,  51622,  51464,  51306,
+	 51150,  50995,  50840,  50686,  50534,  50382,  50231,  50081,
+	 49932,  49784,  49637,  49490,  49345,  49200,  49056,  48913,
+	 48771,  48630,  48489,  48349,  48210,  48072,  47935,  47798,
+	 47663,  47528,  47393,  47260,  47127,  46995,  46864,  46733,
+	 46603,  46474,  46346,  46218,  46091,  45965,  45839,  45714,
+	 45590,  45467,  45344,  45222,  45100,  44979,  44859,  44739,
+	 44620,  44502,  44384,  44267,  44151,  44035,  43919,  43805,
+	 43691,  43577,  43464,  43352,  43240,  43129,  43019,  42908,
+	 42799,  42690,  42582,  42474,  42367,  42260,  42154,  42048,
+	 41943,  41838,  41734,  41631,  41528,  41425,  41323,  41222,
+	 41121,  41020,  40920,  40820,  40721,  40623,  40525,  40427,
+	 40330,  40233,  40137,  40041,  39946,  39851,  39756,  39662,
+	 39569,  39476,  39383,  39291,  39199,  39108,  39017,  38926,
+	 38836,  38746,  38657,  38568,  38480,  38392,  38304,  38217,
+	 38130,  38044,  37958,  37872,  37787,  37702,  37617,  37533,
+	 37449,  37366,  37283,  37200,  37118,  37036,  36954,  36873,
+	 36792,  36712,  36631,  36552,  36472,  36393,  36314,  36236,
+	 36158,  36080,  36003,  35926,  35849,  35772,  35696,  35620,
+	 35545,  35470,  35395,  35320,  35246,  35172,  35099,  35026,
+	 34953,  34880,  34808,  34735,  34664,  34592,  34521,  34450,
+	 34380,  34309,  34239,  34169,  34100,  34031,  33962,  33893,
+	 33825,  33757,  33689,  33622,  33554,  33487,  33421,  33354,
+	 33288,  33222,  33157,  33091,  33026,  32961,  32897,  32832,
+	 32768,
+};
+
+/* Arctangent table, atan(n / 256) in 1/65536ths of a turn, n = 0..256. */
+static const uint16_t fm_atan[257] = {
+	    0,    41,    81,   122,   163,   204,   244,   285,
+	  326,   367,   407,   448,   489,   529,   570,   610,
+	  651,   692,   732,   773,   813,   854,   894,   935,
+	  975,  1015,  1056,  1096,  1136,  1177,  1217,  1257,
+	 1297,  1337,  1377,  1417,  1457,  1497,  1537,  1577,
+	 1617,  1656,  1696,  1736,  1775,  1815,  1854,  1894,
+	 1933,  1973,  2012,  2051,  2090,  2129,  2168,  2207,
+	 2246,  2285,  2324,  2363,  2401,  2440,  2478,  2517,
+	 2555,  2594,  2632,  2670,  2708,  2746,  2784,  2822,
+	 2860,  2897,  2935,  2973,  3010,  3047,  3085,  3122,
+	 3159,  3196,  3233,  3270,  3307,  3344,  3380,  3417,
+	 3453,  3490,  3526,  3562,  3599,  3635,  3670,  3706,
+	 3742,  3778,  3813,  3849,  3884,  3920,  3955,  3990,
+	 4025,  4060,  4095,  4129,  4164,  4199,  4233,  4267,
+	 4302,  4336,  4370,  4404,  4438,  4471,  4505,  4539,
+	 4572,  4605,  4639,  4672,  4705,  4738,  4771,  4803,
+	 4836,  4869,  4901,  4933,  4966,  4998,  5030,  5062,
+	 5094,  5125,  5157,  5188,  5220,  5251,  5282,  5313,
+	 5344,  5375,  5406,  5437,  5467,  5498,  5528,  5559,
+	 5589,  5619,  5649,  5679,  5708,  5738,  5768,  5797,
+	 5826,  5856,  5885,  5914,  5943,  5972,  6000,  6029,
+	 6058,  6086,  6114,  6142,  6171,  6199,  6227,  6254,
+	 6282,  6310,  6337,  6365,  6392,  6419,  6446,  6473,
+	 6500,  6527,  6554,  6580,  6607,  6633,  6660,  6686,
+	 6712,  6738,  6764,  6790,  6815,  6841,  6867,  6892,
+	 6917,  6943,  6968,  6993,  7018,  7043,  7068,  7092,
+	 7117,  7141,  7166,  7190,  7214,  7238,  7262,  7286,
+	 7310,  7334,  7358,  7381,  7405,  7428,  7451,  7475,
+	 7498,  7521,  7544,  7566,  7589,  7612,  7635,  7657,
+	 7679,  7702,  7724,  7746,  7768,  7790,  7812,  7834,
+	 7856,  7877,  7899,  7920,  7942,  7963,  7984,  8005,
+	 8026,  8047,  8068,  8089,  8110,  8131,  8151,  8172,
+	 8192,
+};
+
+/* Angle of (x, y) in 1/65536ths of a turn, same units and wrap as
+ * fxpt_atan2(y, x). The octant is folded out, min/max is formed with a
+ * CLZ-normalized, interpolated reciprocal table (no divide), and the
+ * arctangent of that ratio is interpolated from a table.
+ */
+__attribute__((always_inline)) static inline int32_t fm_angle(const int32_t x, const int32_t y) {
+	const uint32_t ax = (x < 0) ? -(uint32_t)x : x;
+	const uint32_t ay = (y < 0) ? -(uint32_t)y : y;
+	const bool swap = ay > ax;
+	const uint32_t big = swap ? ay : ax;
+	const uint32_t small = swap ? ax : ay;
+
+	const uint32_t shift = __CLZ(big | 1);
+	const uint32_t b = (big << shift) >> 16;			/* 32768..65535, or 0 */
+	const uint32_t s = (small << shift) >> 16;			/* 0..b */
+
+	const uint32_t rn = ((b >> 7) - 256) & 255;
+	const uint32_t rf = b & 127;
+	const uint32_t reciprocal = fm_reciprocal[rn] - (((fm_reciprocal[rn] - fm_reciprocal[rn + 1]) * rf) >> 7);
+	uint32_t ratio = (s * reciprocal) >> 16;			/* small / big, 0..32768 */
+	if( ratio > 32767 ) {
+		ratio = 32767;
+	}
+
+	const uint32_t an = ratio >> 7;
+	const uint32_t af = ratio & 127;
+	int32_t angle = fm_atan[an] + (((fm_atan[an + 1] - fm_atan[an]) * af) >> 7);	/* 0..8192 */
+
+	if( swap ) {
+		angle = 16384 - angle;
+	}
+	/* INT32_MIN is a wrapped +2^31 from SMUAD; see fm_demodulate_s16_s16. */
+	if( (x < 0) && (x != INT32_MIN) ) {
+		angle = 32768 - angle;
+	}
+	if( y < 0 ) {
+		angle = -angle;
+	}
+	return (int16_t)angle;
+}
+
 void fm_demodulate_s16_s16_init(fm_demodulate_s16_s16_state_t* const state, const float sampling_rate, const float deviation_hz) {
-	state->z1.i = state->z1.q = 0;
-	state->k = sampling_rate / (2.0f * M_PI * deviation_hz);
+	state->z1 = 0;
+	/* Output = phase step (1/65536 turn) * sampling_rate / (16 * deviation_hz),
+	 * so the configured deviation comes out as 4096. gain is 16.16.
+	 */
+	state->gain = (sampling_rate * 4096.0f) / deviation_hz;
 }
 
 void fm_demodulate_s16_s16(
@@ -84,16 +348,41 @@ void fm_demodulate_s16_s16(
 	int16_t* dst,
 	int32_t n
 ) {
-	complex_s16_t z1 = state->z1;
-	// TODO: Gain compensation based on ratio of sampling rate and deviation?
-	//const int32_t decimation_rate = 1;
-	//const float k = state->k * 4096.0f / decimation_rate;
-	const complex_s16_t* p = src;
-	for(; n>0; n-=1) {
-		const complex_s16_t s = *(p++);
-		const complex_s32_t t = multiply_conjugate_s16_s32(s, z1);
-		z1 = s;
-		*(dst++) = fxpt_atan2(t.q >> 12, t.i >> 12) >> 1;
+	/* complex<int16_t> input (sample count "n" must be multiple of 2)
+	 * -> int16_t output, instantaneous frequency, configured deviation = 4096.
+	 *
+	 * The phase step is arg(s[n] * conj(s[n-1])), with the conjugate product
+	 * done by SMUAD/SMUSDX at full precision. Two samples per iteration.
+	 *
+	 * Phase steps are within 3/65536 turn of exact atan2, at any signal
+	 * level. With a gain of 0.5 (AIS), output matches the previous
+	 * fxpt_atan2 version to within that version's own error (+/-48 LSB)
+	 * for mid-level signals. On strong signals its Q15 divide overflowed,
+	 * and on weak signals the >> 12 before it discarded the phase.
+	 *
+	 * SMUSDX can't overflow: one product would have to be -32768 * 32768.
+	 * SMUAD overflows only when both samples are (-32768, -32768), and
+	 * then wraps to INT32_MIN, which fm_angle() reads as +2^31.
+	 */
+	const uint32_t gain = state->gain;
+	uint32_t z1 = state->z1;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+	for(; n>0; n-=2) {
+		const uint32_t s0 = *(s++);
+		const uint32_t s1 = *(s++);
+
+		const int32_t x0 = __SMUAD(s0, z1);			/* 1: I0*I(-1) + Q0*Q(-1) */
+		const int32_t y0 = __SMUSDX(z1, s0);		/* 1: Q0*I(-1) - I0*Q(-1) */
+		const int32_t x1 = __SMUAD(s1, s0);			/* 1: I1*I0 + Q1*Q0 */
+		const int32_t y1 = __SMUSDX(s0, s1);		/* 1: Q1*I0 - I1*Q0 */
+		z1 = s1;
+
+		const int32_t a0 = fm_angle(x0, y0);
+		const int32_t a1 = fm_angle(x1, y1);
+		const int32_t f0 = __SSAT(__SMULWB(gain, a0), 16);
+		const int32_t f1 = __SSAT(__SMULWB(gain, a1), 16);
+		*(d++) = __PKHBT(f0, f1, 16);
 	}
 	state->z1 = z1;
 }
@@ -27,15 +27,69 @@
 
 #include "complex.h"
 
+/* Integer magnitude, no square root or float. Selectable accuracy (relative
+ * error of the magnitude, for magnitudes where integer truncation doesn't
+ * dominate):
+ */
+typedef enum am_magnitude_t {
+	AM_MAGNITUDE_FAST = 0,		/* 15/16 max + 15/32 min: -6.3% to +4.9% */
+	AM_MAGNITUDE_BETTER = 1,	/* max(max + min/8, 27/32 max + 9/16 min): -1.7% to +1.5% */
+	AM_MAGNITUDE_EXACT = 2,		/* table-interpolated square root: within 3 LSB, +/-0.05% at 1024, +/-0.016% at 4096 */
+} am_magnitude_t;
+
+/* Sample count "n" must be a multiple of 2 for all AM demodulators. */
 void am_demodulate_s16_s16(
 	complex_s16_t* src,
 	uint16_t* dst,
+	int32_t n,
+	const am_magnitude_t magnitude
+);
+
+/* Envelope-normalized magnitude for slicing on-off keyed signals, from
+ * am_demodulate_s16_s16() output: 2 * m / envelope - 1 in Q13, saturated
+ * to int16, so the carrier is about +1.0 and no carrier is -1.0. The
+ * envelope follows the magnitude up by rise_factor and down by
+ * fall_factor of the difference per sample.
+ */
+typedef struct am_envelope_normalize_u16_s16_state_t {
+	int32_t envelope;		/* Q4 */
+	int32_t rise;			/* Q15 */
+	int32_t fall;			/* Q15 */
+} am_envelope_normalize_u16_s16_state_t;
+
+void am_envelope_normalize_u16_s16_init(
+	am_envelope_normalize_u16_s16_state_t* const state,
+	const float rise_factor,
+	const float fall_factor
+);
+
+void am_envelope_normalize_u16_s16(
+	am_envelope_normalize_u16_s16_state_t* const state,
+	const uint16_t* src,
+	int16_t* dst,
 	int32_t n
 );
 
-void am_demodulate_s16_f32(
+/* Magnitude followed by a one-pole DC-removal high-pass filter in the same
+ * pass: y = m - dc, dc += (m - dc) / 2^hpf_shift. Corner frequency is about
+ * fs / (2 * pi * 2^hpf_shift). Output saturated to int16.
+ */
+typedef struct am_demodulate_hpf_s16_s16_state_t {
+	int32_t dc;
+	uint32_t hpf_shift;
+	am_magnitude_t magnitude;
+} am_demodulate_hpf_s16_s16_state_t;
+
+void am_demodulate_hpf_s16_s16_init(
+	am_demodulate_hpf_s16_s16_state_t* const state,
+	const am_magnitude_t magnitude,
+	const uint32_t hpf_shift
+);
+
+void am_demodulate_hpf_s16_s16(
+	am_demodulate_hpf_s16_s16_state_t* const state,
 	complex_s16_t* src,
-	float* dst,
+	int16_t* dst,
 	int32_t n
 );
 
@@ -53,8 +107,8 @@ void fm_demodulate_s32_s32(
 );
 
 typedef struct fm_demodulate_s16_s16_state_t {
-	complex_s16_t z1;
-	float k;
+	uint32_t z1;	/* previous sample, packed Q:I */
+	uint32_t gain;
 } fm_demodulate_s16_s16_state_t;
 
 void fm_demodulate_s16_s16_init(fm_demodulate_s16_s16_state_t* const state, const float sampling_rate, const float deviation_hz);
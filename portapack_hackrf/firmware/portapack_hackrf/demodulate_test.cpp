@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "demodulate_test.h"
+
+#include "demodulate.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#include "complex.h"
+
+/* sampling_rate / deviation_hz of 16 makes the gain 1.0, so the output
+ * is the phase step in 1/65536ths of a turn.
+ */
+static int test_fm_demodulate_s16_s16_angle(const float amplitude, const float step) {
+	complex_s16_t data[64];
+	for(size_t n=0; n<64; n++) {
+		const float phase = 2.0f * (float)M_PI * step * n / 65536.0f;
+		data[n].i = lrintf(amplitude * cosf(phase));
+		data[n].q = lrintf(amplitude * sinf(phase));
+	}
+
+	fm_demodulate_s16_s16_state_t state;
+	fm_demodulate_s16_s16_init(&state, 16.0f, 1.0f);
+	int16_t out[64];
+	fm_demodulate_s16_s16(&state, &data[ 0], &out[ 0], 16);
+	fm_demodulate_s16_s16(&state, &data[16], &out[16], 48);
+
+	/* Exact angle of the same rounded samples, within 3/65536 turn. */
+	for(size_t n=1; n<64; n++) {
+		const double x = (double)data[n].i * data[n-1].i + (double)data[n].q * data[n-1].q;
+		const double y = (double)data[n].q * data[n-1].i - (double)data[n].i * data[n-1].q;
+		const int32_t expected = lrint(atan2(y, x) * 65536.0 / (2.0 * M_PI));
+		const int32_t error = (int16_t)(out[n] - expected);
+		if( (error > 3) || (error < -3) ) {
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int test_fm_demodulate_s16_s16_full_scale() {
+	/* SMUAD wraps for two (-32768, -32768) samples; the step is still 0. */
+	complex_s16_t data[8];
+	for(size_t n=0; n<8; n++) {
+		data[n].i = data[n].q = -32768;
+	}
+
+	fm_demodulate_s16_s16_state_t state;
+	fm_demodulate_s16_s16_init(&state, 16.0f, 1.0f);
+	int16_t out[8];
+	fm_demodulate_s16_s16(&state, data, out, 8);
+
+	for(size_t n=1; n<8; n++) {
+		if( out[n] != 0 ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int test_fm_demodulate_s16_s16() {
+	const float amplitudes[] = { 40.0f, 1000.0f, 23000.0f, 32767.0f };
+	const float steps[] = { -30000.0f, -4096.0f, -7.0f, 0.0f, 13.0f, 2048.0f, 11111.0f, 32000.0f };
+	for(size_t a=0; a<sizeof(amplitudes)/sizeof(amplitudes[0]); a++) {
+		for(size_t s=0; s<sizeof(steps)/sizeof(steps[0]); s++) {
+			if( !test_fm_demodulate_s16_s16_angle(amplitudes[a], steps[s]) ) {
+				return 0;
+			}
+		}
+	}
+	return test_fm_demodulate_s16_s16_full_scale();
+}
+
+/* A steady carrier settles at +1.0 (Q13), and no carrier reads -1.0. */
+static int test_am_envelope_normalize_u16_s16() {
+	const uint16_t levels[] = { 300, 20000, 46341 };
+	for(size_t l=0; l<sizeof(levels)/sizeof(levels[0]); l++) {
+		am_envelope_normalize_u16_s16_state_t state;
+		am_envelope_normalize_u16_s16_init(&state, 0.08f, 0.01f);
+
+		uint16_t carrier[128];
+		int16_t out[128];
+		for(size_t n=0; n<128; n++) {
+			carrier[n] = levels[l];
+		}
+		for(size_t block=0; block<4; block++) {
+			am_envelope_normalize_u16_s16(&state, carrier, out, 128);
+		}
+		for(size_t n=0; n<128; n++) {
+			if( (out[n] < 8192 - 64) || (out[n] > 8192 + 64) ) {
+				return 0;
+			}
+		}
+
+		const uint16_t gap[8] = { 0 };
+		am_envelope_normalize_u16_s16(&state, gap, out, 8);
+		for(size_t n=0; n<8; n++) {
+			if( out[n] != -8192 ) {
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void demodulate_test() {
+	halt_if_failed(test_fm_demodulate_s16_s16());
+	halt_if_failed(test_am_envelope_normalize_u16_s16());
+}
@@ -19,46 +19,195 @@
  * Boston, MA 02110-1301, USA.
  */
 
-#include "portapack.h"
+#include "fft.h"
+
+#include "arm_intrinsics.h"
+
+#include "sin_table.h"
 
 #include <stdint.h>
-#include <math.h>
-
-/* http://beige.ucs.indiana.edu/B673/node14.html */
-/* http://www.drdobbs.com/cpp/a-simple-and-efficient-fft-implementatio/199500857?pgno=3 */
-
-void fft_c_preswapped(float* data_preswapped, unsigned long nn)
-{
-	uint32_t n, mmax, m, j, istep, i;
-	float wtemp, wr, wpr, wpi, wi, theta;
-	float tempr, tempi;
- 
-	n = nn<<1;
-	mmax=2;
-	while( n > mmax ) {
-		istep = 2 * mmax;
-		theta = -(2.0f * M_PI / mmax);
-		wtemp = sinf(0.5f * theta);
-		wpr = -2.0f * wtemp * wtemp;
-		wpi = sinf(theta);
-		wr = 1.0f;
-		wi = 0.0f;
-		for (m=1; m < mmax; m += 2) {
-			for (i=m; i <= n; i += istep) {
-				j=i+mmax;
-
-				tempr = wr * data_preswapped[j-1] - wi * data_preswapped[j];
-				tempi = wr * data_preswapped[j]   + wi * data_preswapped[j-1];
- 
-				data_preswapped[j-1]  = data_preswapped[i-1] - tempr;
-				data_preswapped[j]    = data_preswapped[i] - tempi;
-				data_preswapped[i-1] += tempr;
-				data_preswapped[i]   += tempi;
+
+/* Twiddles come from one quarter-wave sine table, sin(pi/2 * i / 512) for
+ * i = 0..512, which covers every twiddle of a FFT_SIZE_MAX transform. The
+ * table is computed by the compiler (see sin_table.h), so there is no
+ * recurrence error build-up across passes.
+ */
+
+#define FFT_QUARTER (FFT_SIZE_MAX / 4)
+
+template<typename List>
+struct fft_sin_table;
+
+template<size_t... I>
+struct fft_sin_table<index_list<I...>> {
+	static constexpr int16_t q15[sizeof...(I)] = { sin_q15(sin_quarter(I, FFT_QUARTER))... };
+	static constexpr float f32[sizeof...(I)] = { (float)sin_quarter(I, FFT_QUARTER)... };
+};
+
+template<size_t... I>
+constexpr int16_t fft_sin_table<index_list<I...>>::q15[sizeof...(I)];
+
+template<size_t... I>
+constexpr float fft_sin_table<index_list<I...>>::f32[sizeof...(I)];
+
+typedef fft_sin_table<make_index_list<FFT_QUARTER + 1>::type> fft_sin_quarter;
+
+/* Twiddle index m is in units of 1/FFT_SIZE_MAX turn. Radix-4 passes only
+ * ask for m < 3/4 turn, so three quadrants are enough.
+ */
+template<typename T>
+static inline void fft_twiddle(const T* const s, const size_t m, T* const c_out, T* const s_out) {
+	if( m < FFT_QUARTER ) {
+		*c_out = s[FFT_QUARTER - m];
+		*s_out = s[m];
+	} else if( m < (2 * FFT_QUARTER) ) {
+		*c_out = -s[m - FFT_QUARTER];
+		*s_out = s[2 * FFT_QUARTER - m];
+	} else {
+		*c_out = -s[3 * FFT_QUARTER - m];
+		*s_out = -s[m - 2 * FFT_QUARTER];
+	}
+}
+
+/* Q15: samples are packed Q:I words, twiddles are packed -sin:cos words so
+ * that SMUSD/SMUADX produce the real/imaginary parts of x * e^(-j*theta).
+ */
+struct fft_ops_q15 {
+	typedef uint32_t sample_t;
+	typedef uint32_t twiddle_t;
+
+	static inline twiddle_t twiddle(const size_t m) {
+		int16_t c, s;
+		fft_twiddle(fft_sin_quarter::q15, m, &c, &s);
+		return (uint16_t)c | ((uint32_t)(uint16_t)-s << 16);
+	}
+
+	static inline void butterfly_2(sample_t* const d) {
+		const uint32_t x0 = d[0];
+		const uint32_t x1 = d[1];
+		const int32_t x0_i = (int16_t)x0, x0_q = (int32_t)x0 >> 16;
+		const int32_t x1_i = (int16_t)x1, x1_q = (int32_t)x1 >> 16;
+		d[0] = __PKHBT((x0_i + x1_i + 1) >> 1, (x0_q + x1_q + 1) >> 1, 16);
+		d[1] = __PKHBT((x0_i - x1_i + 1) >> 1, (x0_q - x1_q + 1) >> 1, 16);
+	}
+
+	static inline void butterfly_4(sample_t* const d, const size_t q, const twiddle_t w1, const twiddle_t w2, const twiddle_t w3) {
+		const uint32_t x0 = d[0];
+		const uint32_t x1 = d[q];
+		const uint32_t x2 = d[2 * q];
+		const uint32_t x3 = d[3 * q];
+
+		const int32_t a_i = (int16_t)x0;
+		const int32_t a_q = (int32_t)x0 >> 16;
+		const int32_t b_i = ((int32_t)__SMUSD(x1, w2) + 0x4000) >> 15;
+		const int32_t b_q = ((int32_t)__SMUADX(x1, w2) + 0x4000) >> 15;
+		const int32_t c_i = ((int32_t)__SMUSD(x2, w1) + 0x4000) >> 15;
+		const int32_t c_q = ((int32_t)__SMUADX(x2, w1) + 0x4000) >> 15;
+		const int32_t e_i = ((int32_t)__SMUSD(x3, w3) + 0x4000) >> 15;
+		const int32_t e_q = ((int32_t)__SMUADX(x3, w3) + 0x4000) >> 15;
+
+		const int32_t t0_i = a_i + b_i, t0_q = a_q + b_q;
+		const int32_t t1_i = a_i - b_i, t1_q = a_q - b_q;
+		const int32_t t2_i = c_i + e_i, t2_q = c_q + e_q;
+		const int32_t t3_i = c_i - e_i, t3_q = c_q - e_q;
+
+		d[0]     = __PKHBT((t0_i + t2_i + 2) >> 2, (t0_q + t2_q + 2) >> 2, 16);
+		d[q]     = __PKHBT((t1_i + t3_q + 2) >> 2, (t1_q - t3_i + 2) >> 2, 16);
+		d[2 * q] = __PKHBT((t0_i - t2_i + 2) >> 2, (t0_q - t2_q + 2) >> 2, 16);
+		d[3 * q] = __PKHBT((t1_i - t3_q + 2) >> 2, (t1_q + t3_i + 2) >> 2, 16);
+	}
+};
+
+struct fft_ops_f32 {
+	typedef complex_t sample_t;
+	typedef complex_t twiddle_t;
+
+	static inline twiddle_t twiddle(const size_t m) {
+		float c, s;
+		fft_twiddle(fft_sin_quarter::f32, m, &c, &s);
+		const complex_t w = { c, -s };
+		return w;
+	}
+
+	static inline complex_t multiply(const complex_t x, const complex_t w) {
+		const complex_t y = { x.r * w.r - x.i * w.i, x.r * w.i + x.i * w.r };
+		return y;
+	}
+
+	static inline void butterfly_2(sample_t* const d) {
+		const complex_t x0 = d[0];
+		const complex_t x1 = d[1];
+		d[0].r = x0.r + x1.r;
+		d[0].i = x0.i + x1.i;
+		d[1].r = x0.r - x1.r;
+		d[1].i = x0.i - x1.i;
+	}
+
+	static inline void butterfly_4(sample_t* const d, const size_t q, const twiddle_t w1, const twiddle_t w2, const twiddle_t w3) {
+		const complex_t a = d[0];
+		const complex_t b = multiply(d[q], w2);
+		const complex_t c = multiply(d[2 * q], w1);
+		const complex_t e = multiply(d[3 * q], w3);
+
+		const float t0_r = a.r + b.r, t0_i = a.i + b.i;
+		const float t1_r = a.r - b.r, t1_i = a.i - b.i;
+		const float t2_r = c.r + e.r, t2_i = c.i + e.i;
+		const float t3_r = c.r - e.r, t3_i = c.i - e.i;
+
+		d[0].r     = t0_r + t2_r; d[0].i     = t0_i + t2_i;
+		d[q].r     = t1_r + t3_i; d[q].i     = t1_i - t3_r;
+		d[2 * q].r = t0_r - t2_r; d[2 * q].i = t0_i - t2_i;
+		d[3 * q].r = t1_r - t3_i; d[3 * q].i = t1_i + t3_r;
+	}
+};
+
+/* Input is copied in radix-2 bit-reversed order, so within each radix-4
+ * group the four sub-transforms sit in the order (0, 2, 1, 3). The
+ * butterfly is laid out accordingly:
+ *
+ *   t0 = x0 + x1 * w^2k    t2 = x2 * w^k + x3 * w^3k
+ *   t1 = x0 - x1 * w^2k    t3 = x2 * w^k - x3 * w^3k
+ *
+ *   y0 = t0 + t2    y1 = t1 - j * t3
+ *   y2 = t0 - t2    y3 = t1 + j * t3
+ *
+ * An odd power of two gets one leading radix-2 pass.
+ */
+template<typename Ops>
+static void fft_execute(const typename Ops::sample_t* const src, typename Ops::sample_t* const dst, const size_t n) {
+	const size_t log2_n = 31 - __CLZ(n);
+
+	for(size_t i=0; i<n; i++) {
+		dst[__RBIT(i) >> (32 - log2_n)] = src[i];
+	}
+
+	size_t l = 4;
+	if( log2_n & 1 ) {
+		for(size_t i=0; i<n; i+=2) {
+			Ops::butterfly_2(&dst[i]);
+		}
+		l = 8;
+	}
+
+	for(; l<=n; l<<=2) {
+		const size_t q = l >> 2;
+		const size_t m_step = FFT_SIZE_MAX / l;
+		for(size_t k=0; k<q; k++) {
+			const size_t m = k * m_step;
+			const typename Ops::twiddle_t w1 = Ops::twiddle(m);
+			const typename Ops::twiddle_t w2 = Ops::twiddle(2 * m);
+			const typename Ops::twiddle_t w3 = Ops::twiddle(3 * m);
+			for(size_t b=k; b<n; b+=l) {
+				Ops::butterfly_4(&dst[b], q, w1, w2, w3);
 			}
-			wtemp=wr;
-			wr += wr*wpr - wi*wpi;
-			wi += wi*wpr + wtemp*wpi;
 		}
-		mmax=istep;
 	}
-}
\ No newline at end of file
+}
+
+void fft_c16(const complex_s16_t* const src, complex_s16_t* const dst, const size_t n) {
+	fft_execute<fft_ops_q15>((const uint32_t*)src, (uint32_t*)dst, n);
+}
+
+void fft_cf32(const complex_t* const src, complex_t* const dst, const size_t n) {
+	fft_execute<fft_ops_f32>(src, dst, n);
+}
@@ -22,6 +22,27 @@
 #ifndef __FFT_H__
 #define __FFT_H__
 
-void fft_c_preswapped(float* data, unsigned long nn);
+#include <stddef.h>
+
+#include "complex.h"
+
+#define FFT_SIZE_MIN 64
+#define FFT_SIZE_MAX 2048
+
+/* Forward complex FFT, mixed radix-4/radix-2, decimation in time.
+ * n must be a power of two from FFT_SIZE_MIN to FFT_SIZE_MAX.
+ * src is in natural order; the bit-reversal permutation happens while
+ * copying into dst, so src and dst must not overlap. dst is in natural
+ * bin order (DC at dst[0]).
+ */
+
+/* Q15 input, scaled by 1/n (1/4 per radix-4 pass, 1/2 per radix-2 pass)
+ * so the output never grows past the input. Input magnitude must not
+ * exceed 32767 (i.e. keep components within +/-23170) to avoid wrapping.
+ */
+void fft_c16(const complex_s16_t* const src, complex_s16_t* const dst, const size_t n);
+
+/* Float version of the same transform, unscaled. */
+void fft_cf32(const complex_t* const src, complex_t* const dst, const size_t n);
 
 #endif
@@ -25,9 +25,9 @@
 /* 96kHz int16_t input
  * -> FIR filter, <15kHz (0.156fs) pass, >19kHz (0.198fs) stop
  * -> 48kHz int16_t output, gain of 1.0 (I think).
- * Padded to multiple of four taps for unrolled FIR code.
+ * Padded to multiple of four taps, word-aligned for unrolled dual-MAC FIR code.
  */
-const int16_t taps_64_lp_156_198[64] = {
+const int16_t taps_64_lp_156_198[64] __attribute__((aligned(4))) = {
     -27,    166,    104,    -36,   -174,   -129,    109,    287,
     148,   -232,   -430,   -130,    427,    597,     49,   -716,
    -778,    137,   1131,    957,   -493,  -1740,  -1121,   1167,
@@ -42,10 +42,10 @@ const int16_t taps_64_lp_156_198[64] = {
 /* 96kHz int16_t input
  * -> FIR filter, <3kHz (0.031fs) pass, >6kHz (0.063fs) stop
  * -> 48kHz int16_t output, gain of 1.0 (I think).
- * Padded to multiple of four taps for unrolled FIR code.
+ * Padded to multiple of four taps, word-aligned for unrolled dual-MAC FIR code.
  */
 /* TODO: Review this filter, it's very quick and dirty. */
-const int16_t taps_64_lp_031_063[64] = {
+const int16_t taps_64_lp_031_063[64] __attribute__((aligned(4))) = {
 	  -254,    255,    244,    269,    302,    325,    325,    290,
 	   215,     99,    -56,   -241,   -442,   -643,   -820,   -950,
 	 -1009,   -974,   -828,   -558,   -160,    361,    992,   1707,
@@ -55,3 +55,44 @@ const int16_t taps_64_lp_031_063[64] = {
 	  -820,   -643,   -442,   -241,    -56,     99,    215,    290,
 	   325,    325,    302,    269,    244,    255,   -254,      0,
 };
+
+/* Half-band decimate-by-2 filters */
+/* Kaiser-windowed, normalized to 1 << 15 == 1.0, gain of 1.0.
+ * For fir_hb_decim_2_*, which only use the non-zero outer taps.
+ */
+
+/* <0.145fs pass (0.1dB), >0.355fs stop (-39dB) */
+const int16_t taps_11_hb[11] = {
+	   428,      0,  -2173,      0,   9937,  16384,   9937,      0,
+	 -2173,      0,    428,
+};
+
+/* <0.180fs pass (0.1dB), >0.320fs stop (-45dB) */
+const int16_t taps_23_hb[23] = {
+	   -35,      0,    188,      0,   -546,      0,   1285,      0,
+	 -2936,      0,  10236,  16384,  10236,      0,  -2936,      0,
+	  1285,      0,   -546,      0,    188,      0,    -35,
+};
+
+/* <0.210fs pass (0.1dB), >0.290fs stop (-59dB) */
+const int16_t taps_47_hb[47] = {
+	   -10,      0,     30,      0,    -65,      0,    122,      0,
+	  -208,      0,    334,      0,   -514,      0,    775,      0,
+	 -1172,      0,   1848,      0,  -3329,      0,  10381,  16384,
+	 10381,      0,  -3329,      0,   1848,      0,  -1172,      0,
+	   775,      0,   -514,      0,    334,      0,   -208,      0,
+	   122,      0,    -65,      0,     30,      0,    -10,
+};
+
+/* Wideband FM channel filter */
+/* 768kHz complex<int16_t> input
+ * -> FIR filter, <100kHz (0.130fs) pass (0.1dB), >200kHz (0.260fs) stop (-55dB)
+ * -> 768kHz complex<int16_t> output, gain of 1.0.
+ * Kaiser-windowed, normalized to 1 << 15 == 1.0, for fir_sym_cplx_s16_s16.
+ */
+const int16_t taps_25_lp_130_260[25] = {
+	    31,     42,    -91,   -259,    -54,    571,    741,   -431,
+	 -2019,  -1285,   3355,   9552,  12462,   9552,   3355,  -1285,
+	 -2019,   -431,    741,    571,    -54,   -259,    -91,     42,
+	    31,
+};
@@ -27,4 +27,10 @@
 extern const int16_t taps_64_lp_156_198[64];
 extern const int16_t taps_64_lp_031_063[64];
 
+extern const int16_t taps_11_hb[11];
+extern const int16_t taps_23_hb[23];
+extern const int16_t taps_47_hb[47];
+
+extern const int16_t taps_25_lp_130_260[25];
+
 #endif/*__FILTERS_H__*/
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "hdlc.h"
+
+/* Running the CRC over data and FCS together gives this value. */
+#define HDLC_CRC_RESIDUE 0x0f47
+
+static void hdlc_decoder_frame_start(hdlc_decoder_t* const decoder) {
+	decoder->in_frame = true;
+	decoder->bit_count = 0;
+	decoder->crc.reset();
+	decoder->start_symbol = decoder->symbols_received;
+}
+
+/* The closing flag's first seven bits (0111111) were taken as data before
+ * the flag could be recognized. For a whole number of bytes they leave
+ * seven bits in the shift register and never reach frame[] or the CRC.
+ */
+static void hdlc_decoder_frame_end(hdlc_decoder_t* const decoder) {
+	const size_t byte_count = decoder->bit_count >> 3;
+	if( ((decoder->bit_count & 7) == 7) && (byte_count >= 3) && (decoder->crc.value() == HDLC_CRC_RESIDUE) ) {
+		const size_t data_length = (byte_count - 2) * 8;
+		decoder->payload_handler(decoder->frame, data_length, decoder->start_symbol, decoder->context);
+	}
+}
+
+void hdlc_decoder_init(
+	hdlc_decoder_t* const decoder,
+	packet_builder_payload_handler_t payload_handler,
+	void* const context
+) {
+	decoder->ones = 0;
+	decoder->bit_count = 0;
+	decoder->shift = 0;
+	decoder->crc.reset();
+	decoder->in_frame = false;
+	decoder->symbols_received = 0;
+	decoder->start_symbol = 0;
+	decoder->payload_handler = payload_handler;
+	decoder->context = context;
+}
+
+void hdlc_decoder_execute_word(
+	hdlc_decoder_t* const decoder,
+	const uint32_t bits,
+	const size_t bit_count
+) {
+	for(size_t n=0; n<bit_count; n++) {
+		const uint32_t bit = (bits >> (31 - n)) & 1;
+		decoder->symbols_received += 1;
+
+		if( bit ) {
+			decoder->ones += 1;
+			if( decoder->ones > 6 ) {
+				/* Abort: seven or more ones. */
+				decoder->in_frame = false;
+				continue;
+			}
+		} else {
+			const uint32_t ones = decoder->ones;
+			decoder->ones = 0;
+			if( ones == 6 ) {
+				/* Flag: ends one frame and starts the next. */
+				if( decoder->in_frame ) {
+					hdlc_decoder_frame_end(decoder);
+				}
+				hdlc_decoder_frame_start(decoder);
+				continue;
+			}
+			if( ones == 5 ) {
+				/* Stuffed zero. */
+				continue;
+			}
+		}
+
+		if( decoder->in_frame ) {
+			decoder->shift = (decoder->shift >> 1) | (bit << 7);
+			decoder->bit_count += 1;
+			if( (decoder->bit_count & 7) == 0 ) {
+				const size_t byte_index = (decoder->bit_count >> 3) - 1;
+				if( byte_index < HDLC_FRAME_BYTES_MAX ) {
+					const uint8_t byte = decoder->shift;
+					decoder->frame[byte_index] = byte;
+					decoder->crc.update(byte);
+				} else {
+					/* Too long to be one of ours. */
+					decoder->in_frame = false;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __HDLC_H__
+#define __HDLC_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "packet_builder.h"
+#include "crc.h"
+
+/* Streaming HDLC receiver, as used by AIS: finds flags, removes stuffed
+ * bits and keeps a running CRC-16/X.25 as bits arrive. Only frames that
+ * are a whole number of bytes and pass the CRC reach the handler, as
+ * data bytes (LSB-first on air, so in their natural order) without the
+ * FCS. payload_length is in bits.
+ */
+#define HDLC_FRAME_BYTES_MAX (32 + 2)
+
+typedef struct hdlc_decoder_t {
+	uint32_t ones;
+	uint32_t bit_count;
+	uint32_t shift;
+	crc_16_x25_t crc;
+	bool in_frame;
+	uint32_t symbols_received;
+	uint32_t start_symbol;
+	packet_builder_payload_handler_t payload_handler;
+	void* context;
+	uint8_t frame[HDLC_FRAME_BYTES_MAX];
+} hdlc_decoder_t;
+
+void hdlc_decoder_init(
+	hdlc_decoder_t* const decoder,
+	packet_builder_payload_handler_t payload_handler,
+	void* const context
+);
+
+/* Up to 32 bits, packed first bit in bit 31. */
+void hdlc_decoder_execute_word(
+	hdlc_decoder_t* const decoder,
+	const uint32_t bits,
+	const size_t bit_count
+);
+
+#endif/*__HDLC_H__*/
@@ -0,0 +1,55 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __INDEX_LIST_H__
+#define __INDEX_LIST_H__
+
+#include <stddef.h>
+
+#include <type_traits>
+
+/* For building lookup tables at compile time: expand a constexpr function
+ * over make_index_list<N>::type in a partial specialization. See
+ * sin_table.h and crc.h.
+ */
+template<size_t... I>
+struct index_list {
+	typedef index_list<I..., (sizeof...(I) + I)...> doubled;
+	typedef index_list<I..., (sizeof...(I) + I)..., 2 * sizeof...(I)> doubled_plus_one;
+};
+
+/* make_index_list<N>::type is index_list<0, 1, ..., N-1> */
+template<size_t N>
+struct make_index_list {
+	typedef typename make_index_list<N / 2>::type half;
+	typedef typename std::conditional<
+		(N & 1),
+		typename half::doubled_plus_one,
+		typename half::doubled
+	>::type type;
+};
+
+template<>
+struct make_index_list<0> {
+	typedef index_list<> type;
+};
+
+#endif/*__INDEX_LIST_H__*/
@@ -35,11 +35,9 @@ typedef struct ipc_command_packet_data_received_t {
 	uint8_t payload[32];
 } ipc_command_packet_data_received_t;
 
+/* Doorbell only: the frame itself is in device_state->spectrum_frames. */
 typedef struct ipc_command_spectrum_data_t {
 	uint32_t id;
-	uint8_t* avg;
-	uint8_t* peak;
-	size_t bins;
 } ipc_command_spectrum_data_t;
 
 typedef struct ipc_command_rtc_second_t {
@@ -34,12 +34,9 @@ void ipc_command_packet_data_received(ipc_channel_t* const channel, const uint8_
 	ipc_channel_write(channel, &command, sizeof(command));
 }
 
-void ipc_command_spectrum_data(ipc_channel_t* const channel, uint8_t* const avg, uint8_t* const peak, const size_t bins) {
+void ipc_command_spectrum_data(ipc_channel_t* const channel) {
 	ipc_command_spectrum_data_t command = {
 		.id = IPC_COMMAND_ID_SPECTRUM_DATA,
-		.avg = avg,
-		.peak = peak,
-		.bins = bins,
 	};
 	ipc_channel_write(channel, &command, sizeof(command));
 }
@@ -36,7 +36,8 @@ typedef enum {
 	IPC_COMMAND_ID_SET_BB_GAIN = 4,
 	IPC_COMMAND_ID_SET_AUDIO_OUT_GAIN = 5,
 	IPC_COMMAND_ID_SET_RECEIVER_CONFIGURATION = 6,
-	IPC_COMMAND_ID_SPECTRUM_DATA_DONE = 7,
+	IPC_COMMAND_ID_SET_SWEEP = 7,
+	IPC_COMMAND_ID_SET_ZOOM = 8,
 } ipc_command_id_t;
 
 typedef struct ipc_command_set_frequency_t {
@@ -69,8 +70,17 @@ typedef struct ipc_command_set_receiver_configuration_t {
 	size_t index;
 } ipc_command_set_receiver_configuration_t;
 
-typedef struct ipc_command_spectrum_data_done_t {
+typedef struct ipc_command_set_sweep_t {
 	uint32_t id;
-} ipc_command_spectrum_data_done_t;
+	int64_t width_hz;
+	size_t dwell_blocks;
+	size_t settle_blocks;
+} ipc_command_set_sweep_t;
+
+typedef struct ipc_command_set_zoom_t {
+	uint32_t id;
+	size_t zoom_factor;
+	int32_t center_offset_hz;
+} ipc_command_set_zoom_t;
 
 #endif/*__IPC_M4_H__*/
@@ -70,9 +70,21 @@ void ipc_command_set_receiver_configuration(ipc_channel_t* const channel, const
 	ipc_channel_write(channel, &command, sizeof(command));
 }
 
-void ipc_command_spectrum_data_done(ipc_channel_t* const channel) {
-	ipc_command_spectrum_data_done_t command = {
-		.id = IPC_COMMAND_ID_SPECTRUM_DATA_DONE,
+void ipc_command_set_sweep(ipc_channel_t* const channel, const int64_t width_hz, const size_t dwell_blocks, const size_t settle_blocks) {
+	ipc_command_set_sweep_t command = {
+		.id = IPC_COMMAND_ID_SET_SWEEP,
+		.width_hz = width_hz,
+		.dwell_blocks = dwell_blocks,
+		.settle_blocks = settle_blocks,
+	};
+	ipc_channel_write(channel, &command, sizeof(command));
+}
+
+void ipc_command_set_zoom(ipc_channel_t* const channel, const size_t zoom_factor, const int32_t center_offset_hz) {
+	ipc_command_set_zoom_t command = {
+		.id = IPC_COMMAND_ID_SET_ZOOM,
+		.zoom_factor = zoom_factor,
+		.center_offset_hz = center_offset_hz,
 	};
 	ipc_channel_write(channel, &command, sizeof(command));
 }
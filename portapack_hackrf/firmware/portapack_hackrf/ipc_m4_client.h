@@ -33,6 +33,7 @@ void ipc_command_set_if_gain(ipc_channel_t* const channel, const int32_t value_d
 void ipc_command_set_bb_gain(ipc_channel_t* const channel, const int32_t value_db);
 void ipc_command_set_audio_out_gain(ipc_channel_t* const channel, const int32_t value_db);
 void ipc_command_set_receiver_configuration(ipc_channel_t* const channel, const size_t index);
-void ipc_command_spectrum_data_done(ipc_channel_t* const channel);
+void ipc_command_set_sweep(ipc_channel_t* const channel, const int64_t width_hz, const size_t dwell_blocks, const size_t settle_blocks);
+void ipc_command_set_zoom(ipc_channel_t* const channel, const size_t zoom_factor, const int32_t center_offset_hz);
 
 #endif/*__IPC_M4_CLIENT_H__*/
@@ -94,7 +94,8 @@ static const command_handler_t command_handler[] = {
 	[IPC_COMMAND_ID_SET_BB_GAIN] = handle_command_set_bb_gain,
 	[IPC_COMMAND_ID_SET_AUDIO_OUT_GAIN] = handle_command_set_audio_out_gain,
 	[IPC_COMMAND_ID_SET_RECEIVER_CONFIGURATION] = handle_command_set_receiver_configuration,
-	[IPC_COMMAND_ID_SPECTRUM_DATA_DONE] = handle_command_spectrum_data_done,
+	[IPC_COMMAND_ID_SET_SWEEP] = handle_command_set_sweep,
+	[IPC_COMMAND_ID_SET_ZOOM] = handle_command_set_zoom,
 };
 
 extern "C" void m0core_isr() {
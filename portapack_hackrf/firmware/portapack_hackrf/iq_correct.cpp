@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "iq_correct.h"
+
+#include "arm_intrinsics.h"
+
+#include <math.h>
+
+/* Imbalance correction is clamped to +/-0.25 per coefficient. Anything
+ * larger is not imbalance, and it keeps the Q correction term within int8.
+ */
+static const float iq_correct_coefficient_max = 0.25f;
+
+void iq_correct_s8_init(iq_correct_s8_state_t* const state, const size_t time_constant_shift) {
+	state->dc = 0;
+	state->q_correction = 0;
+	state->q_correction_active = false;
+	state->estimated = false;
+	state->smoothing = 1.0f / (1 << time_constant_shift);
+	state->mean_i = 0.0f;
+	state->mean_q = 0.0f;
+	state->var_i = 0.0f;
+	state->var_q = 0.0f;
+	state->cov_iq = 0.0f;
+}
+
+static int32_t iq_correct_round(const float value) {
+	return (value >= 0.0f) ? (int32_t)(value + 0.5f) : -(int32_t)(0.5f - value);
+}
+
+static int32_t iq_correct_coefficient_q15(const float value) {
+	const float clamped = fminf(fmaxf(value, -iq_correct_coefficient_max), iq_correct_coefficient_max);
+	return iq_correct_round(clamped * 32768.0f);
+}
+
+static void iq_correct_s8_update(iq_correct_s8_state_t* const state) {
+	const int32_t dc_i = iq_correct_round(fminf(fmaxf(state->mean_i, -127.0f), 127.0f));
+	const int32_t dc_q = iq_correct_round(fminf(fmaxf(state->mean_q, -127.0f), 127.0f));
+	const uint32_t dc_iq = (uint8_t)dc_i | ((uint32_t)(uint8_t)dc_q << 8);
+	state->dc = dc_iq | (dc_iq << 16);
+
+	/* Q minus its projection on I, scaled to the power of I. */
+	if( state->var_i <= 0.0f ) {
+		return;
+	}
+	const float projection = state->cov_iq / state->var_i;
+	const float var_orthogonal = state->var_q - state->cov_iq * projection;
+	if( var_orthogonal <= 0.0f ) {
+		return;
+	}
+	const float d = sqrtf(state->var_i / var_orthogonal);
+	const float c = -d * projection;
+
+	const int32_t c_q15 = iq_correct_coefficient_q15(c);
+	const int32_t d_minus_1_q15 = iq_correct_coefficient_q15(d - 1.0f);
+	state->q_correction = __PKHBT(c_q15, d_minus_1_q15, 16);
+
+	/* |correction| <= 128 * (|c| + |d - 1|) LSBs. */
+	const int32_t correction_max = 128 * (((c_q15 < 0) ? -c_q15 : c_q15) + ((d_minus_1_q15 < 0) ? -d_minus_1_q15 : d_minus_1_q15));
+	state->q_correction_active = (correction_max >= (1 << 14));
+}
+
+void iq_correct_s8_estimate(iq_correct_s8_state_t* const state, const complex_s8_t* const src, const size_t sample_count) {
+	/* Two samples (one word) per iteration. SXTB16 splits the word into
+	 * I1:I0 and Q1:Q0, and each SMLAD then sums two products at once.
+	 * Sums stay within int32 for blocks of up to 2^17 samples.
+	 */
+	const uint32_t ones = 0x00010001;
+	const uint32_t* s = (const uint32_t*)src;
+	int32_t sum_i = 0, sum_q = 0;
+	int32_t sum_ii = 0, sum_qq = 0, sum_iq = 0;
+
+	for(size_t n=sample_count; n>0; n-=2) {
+		const uint32_t w = *(s++);					/* 2: Q1:I1:Q0:I0 */
+		const uint32_t i = __SXTB16(w, 0);			/* 1: I1:I0 */
+		const uint32_t q = __SXTB16(w, 8);			/* 1: Q1:Q0 */
+		sum_i = __SMLAD(i, ones, sum_i);			/* 1 */
+		sum_q = __SMLAD(q, ones, sum_q);			/* 1 */
+		sum_ii = __SMLAD(i, i, sum_ii);				/* 1 */
+		sum_qq = __SMLAD(q, q, sum_qq);				/* 1 */
+		sum_iq = __SMLAD(i, q, sum_iq);				/* 1 */
+	}
+
+	const float scale = 1.0f / sample_count;
+	const float mean_i = sum_i * scale;
+	const float mean_q = sum_q * scale;
+	const float var_i = sum_ii * scale - mean_i * mean_i;
+	const float var_q = sum_qq * scale - mean_q * mean_q;
+	const float cov_iq = sum_iq * scale - mean_i * mean_q;
+
+	/* Start from the first measurement rather than from zero. */
+	const float k = state->estimated ? state->smoothing : 1.0f;
+	state->mean_i += (mean_i - state->mean_i) * k;
+	state->mean_q += (mean_q - state->mean_q) * k;
+	state->var_i += (var_i - state->var_i) * k;
+	state->var_q += (var_q - state->var_q) * k;
+	state->cov_iq += (cov_iq - state->cov_iq) * k;
+	state->estimated = true;
+
+	iq_correct_s8_update(state);
+}
+
+size_t iq_correct_s8(
+	const iq_correct_s8_state_t* const state,
+	complex_s8_t* const src_and_dst,
+	const size_t sample_count
+) {
+	const uint32_t dc = state->dc;
+	uint32_t* p = (uint32_t*)src_and_dst;
+
+	if( !state->q_correction_active ) {
+		for(size_t n=sample_count; n>0; n-=2) {
+			*p = __QSUB8(*p, dc);					/* 3: Q1-dc:I1-dc:Q0-dc:I0-dc */
+			p++;
+		}
+		return sample_count;
+	}
+
+	/* The Q correction terms for both samples come from one SMLAD each,
+	 * are packed into bytes 1 and 3 of a word and added to the Q bytes
+	 * with a saturating QADD8. Rounded with the SMLAD accumulator.
+	 */
+	const uint32_t q_correction = state->q_correction;
+	const uint32_t round = 1 << 14;
+	for(size_t n=sample_count; n>0; n-=2) {
+		const uint32_t w = __QSUB8(*p, dc);			/* 3: Q1:I1:Q0:I0, DC removed */
+		const uint32_t i = __SXTB16(w, 0);			/* 1: I1:I0 */
+		const uint32_t q = __SXTB16(w, 8);			/* 1: Q1:Q0 */
+		const uint32_t x0 = __PKHBT(i, q, 16);		/* 1: Q0:I0 */
+		const uint32_t x1 = __PKHTB(q, i, 16);		/* 1: Q1:I1 */
+		const uint32_t d0 = __SMLAD(x0, q_correction, round);	/* 1: c*I0 + (d-1)*Q0 */
+		const uint32_t d1 = __SMLAD(x1, q_correction, round);	/* 1: c*I1 + (d-1)*Q1 */
+		const uint32_t d10 = __PKHTB(d1 << 1, d0, 15);			/* 2: D1:D0 */
+		const uint32_t correction = (d10 & 0x00ff00ff) << 8;	/* 2: D1:0:D0:0 */
+		*(p++) = __QADD8(w, correction);			/* 2 */
+	}
+	return sample_count;
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __IQ_CORRECT_H__
+#define __IQ_CORRECT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "complex.h"
+
+/* DC offset and IQ imbalance correction on raw complex<int8_t> baseband,
+ * in place, ahead of the -fs/4 translate.
+ *
+ * iq_correct_s8_estimate() measures mean, variance and I/Q covariance over
+ * a (sub)block and folds them into leaky averages with a time constant of
+ * 2^time_constant_shift blocks. From those, I is the reference and Q is
+ * made orthogonal to I and of equal power (Gram-Schmidt):
+ *
+ *   I' = I - dc_i
+ *   Q' = c * (I - dc_i) + d * (Q - dc_q)
+ *
+ * iq_correct_s8() applies that with the current coefficients. DC removal
+ * is one saturating QSUB8 per two samples, with DC rounded to a whole LSB.
+ * The Q correction is skipped while it could not move any sample by half
+ * an LSB.
+ */
+typedef struct iq_correct_s8_state_t {
+	uint32_t dc;			/* Rounded DC, Q:I:Q:I bytes */
+	uint32_t q_correction;	/* Q15 (d - 1):c, for SMLAD with a Q:I sample */
+	bool q_correction_active;
+	bool estimated;
+	float smoothing;
+	float mean_i;
+	float mean_q;
+	float var_i;
+	float var_q;
+	float cov_iq;
+} iq_correct_s8_state_t;
+
+void iq_correct_s8_init(iq_correct_s8_state_t* const state, const size_t time_constant_shift);
+
+/* sample_count must be a multiple of 2. */
+void iq_correct_s8_estimate(iq_correct_s8_state_t* const state, const complex_s8_t* const src, const size_t sample_count);
+
+/* sample_count must be a multiple of 2. */
+size_t iq_correct_s8(
+	const iq_correct_s8_state_t* const state,
+	complex_s8_t* const src_and_dst,
+	const size_t sample_count
+);
+
+#endif/*__IQ_CORRECT_H__*/
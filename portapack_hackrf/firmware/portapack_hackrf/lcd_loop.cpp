@@ -49,7 +49,6 @@
 #include "ipc_m4_client.h"
 
 #include "bits.h"
-#include "crc.h"
 
 #include <array>
 #include <algorithm>
@@ -147,6 +146,7 @@ static void draw_cycles(const uint_fast16_t x, const uint_fast16_t y) {
 	draw_int(metrics->duration_audio,          "Audio %6d", x, y + 64);
 	draw_int(metrics->duration_all,            "Total %6d", x, y + 80);
 	draw_percent(metrics->duration_all_millipercent, "CPU   %3d.%01d%%", x, y + 96);
+	draw_int(metrics->sweep_mhz_per_s,         "MHz/s %6d", x, y + 112);
 }
 #endif
 
@@ -317,6 +317,108 @@ static const void* get_tuning_step_size_name() {
 	return get_tuning_step_size()->name;
 }
 
+struct sweep_width_t {
+	const int64_t width_hz;
+	const char* const name;
+};
+
+static const std::array<sweep_width_t, 7> sweep_widths { {
+	{   20000000, "Span   20MHz" },
+	{   40000000, "Span   40MHz" },
+	{   80000000, "Span   80MHz" },
+	{  120000000, "Span  120MHz" },
+	{  240000000, "Span  240MHz" },
+	{  480000000, "Span  480MHz" },
+	{ 1000000000, "Span 1000MHz" },
+} };
+
+/* Matches the width sweep_init() starts with. */
+#define SWEEP_WIDTH_INDEX_DEFAULT 3
+
+size_t sweep_width_index = SWEEP_WIDTH_INDEX_DEFAULT;
+
+static void ui_set_sweep_width(const size_t index) {
+	sweep_width_index = index;
+	ipc_command_set_sweep(&device_state->ipc_m4, sweep_widths[sweep_width_index].width_hz, 1, 4);
+}
+
+struct zoom_factor_t {
+	const size_t factor;
+	const char* const name;
+};
+
+static const std::array<zoom_factor_t, 8> zoom_factors { {
+	{   2, "Zoom    2x" },
+	{   4, "Zoom    4x" },
+	{   8, "Zoom    8x" },
+	{  16, "Zoom   16x" },
+	{  32, "Zoom   32x" },
+	{  64, "Zoom   64x" },
+	{ 128, "Zoom  128x" },
+	{ 256, "Zoom  256x" },
+} };
+
+/* Matches the factor zoom_init() starts with. */
+#define ZOOM_FACTOR_INDEX_DEFAULT 3
+
+size_t zoom_factor_index = ZOOM_FACTOR_INDEX_DEFAULT;
+
+static void ui_set_zoom_factor(const size_t index) {
+	zoom_factor_index = index;
+	ipc_command_set_zoom(&device_state->ipc_m4, zoom_factors[zoom_factor_index].factor, 0);
+}
+
+static const void* get_span_name() {
+	switch(device_state->receiver_configuration_index) {
+	case RECEIVER_CONFIGURATION_SWEEP:
+		return sweep_widths[sweep_width_index].name;
+
+	case RECEIVER_CONFIGURATION_ZOOM:
+		return zoom_factors[zoom_factor_index].name;
+
+	default:
+		return "";
+	}
+}
+
+static void ui_field_value_up_span() {
+	switch(device_state->receiver_configuration_index) {
+	case RECEIVER_CONFIGURATION_SWEEP:
+		if( (sweep_width_index + 1) < sweep_widths.size() ) {
+			ui_set_sweep_width(sweep_width_index + 1);
+		}
+		break;
+
+	case RECEIVER_CONFIGURATION_ZOOM:
+		if( (zoom_factor_index + 1) < zoom_factors.size() ) {
+			ui_set_zoom_factor(zoom_factor_index + 1);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+static void ui_field_value_down_span() {
+	switch(device_state->receiver_configuration_index) {
+	case RECEIVER_CONFIGURATION_SWEEP:
+		if( sweep_width_index > 0 ) {
+			ui_set_sweep_width(sweep_width_index - 1);
+		}
+		break;
+
+	case RECEIVER_CONFIGURATION_ZOOM:
+		if( zoom_factor_index > 0 ) {
+			ui_set_zoom_factor(zoom_factor_index - 1);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
 static void ui_field_value_up_frequency() {
 	ipc_command_set_frequency(&device_state->ipc_m4, device_state->tuned_hz + get_tuning_step_size_hz());
 }
@@ -360,12 +462,16 @@ static void ui_field_value_down_audio_out_gain() {
 static void ui_field_value_up_receiver_configuration() {
 	ipc_command_set_receiver_configuration(&device_state->ipc_m4, device_state->receiver_configuration_index + 1);
 	console_init(&console, &lcd, 16 * 6, lcd.size.h);
+	sweep_width_index = SWEEP_WIDTH_INDEX_DEFAULT;
+	zoom_factor_index = ZOOM_FACTOR_INDEX_DEFAULT;
 }
 
 static void ui_field_value_down_receiver_configuration() {
 	if( device_state->receiver_configuration_index > 0 ) {
 		ipc_command_set_receiver_configuration(&device_state->ipc_m4, device_state->receiver_configuration_index - 1);
 		console_init(&console, &lcd, 16 * 6, lcd.size.h);
+		sweep_width_index = SWEEP_WIDTH_INDEX_DEFAULT;
+		zoom_factor_index = ZOOM_FACTOR_INDEX_DEFAULT;
 	}
 }
 
@@ -455,6 +561,19 @@ static const ui_widget_t ui_field_tuning_step_size {
 	render_field_str,
 };
 
+static const ui_widget_t ui_field_span {
+	{ 0 * 8, 5 * 16 },
+	{ 13 * 8, 16 },
+	UI_WIDGET_FLAGS_FOCUS,
+	{
+		ui_field_value_up_span,
+		ui_field_value_down_span,
+	},
+	"%-13s",
+	get_span_name,
+	render_field_str,
+};
+
 static const ui_widget_t ui_field_audio_out_gain {
 	{ 20 * 8, 5 * 16 },
 	{ 10 * 8, 16 },
@@ -494,7 +613,7 @@ static const ui_widget_t ui_rssi_bar {
 	render_field_rssi,
 };
 
-static const std::array<const ui_widget_t*, 9> widgets {
+static const std::array<const ui_widget_t*, 10> widgets {
 	&ui_rssi_bar,
 	&ui_cpu_bar,
 	&ui_field_frequency,
@@ -503,6 +622,7 @@ static const std::array<const ui_widget_t*, 9> widgets {
 	&ui_field_bb_gain,
 	&ui_field_receiver_configuration,
 	&ui_field_tuning_step_size,
+	&ui_field_span,
 	&ui_field_audio_out_gain,
 };
 
@@ -1002,7 +1122,7 @@ void handle_command_packet_data_received_ask(const void* const arg) {
 
 	uint8_t value[5];
 	uint8_t errors[5];
-	manchester_decode(command->payload, value, errors, 37);
+	manchester_decode(command->payload, value, errors, 37, MANCHESTER_IEEE_802_3);
 
 	const uint_fast8_t flag_group_1[] = {
 		(uint_fast8_t)(value[0] >> 7) & 1,
@@ -1075,7 +1195,7 @@ void handle_command_packet_data_received_fsk(const void* const arg) {
 
 	uint8_t value[10];
 	uint8_t errors[10];
-	manchester_decode(command->payload, value, errors, 80);
+	manchester_decode(command->payload, value, errors, 80, MANCHESTER_IEEE_802_3);
 
 	for(size_t i=0; i<10; i++) {
 		set_console_error_color(errors[i] >> 4);
@@ -1121,54 +1241,6 @@ void handle_command_packet_data_received_fsk(const void* const arg) {
 	console_writeln(&console, "");
 }
 
-static uint32_t reverse_byte(const uint32_t v) {
-	uint32_t r = 0;
-	for(size_t j=0; j<8; j++) {
-		r <<= 1;
-		r |= (v >> j) & 1;
-	}
-	return r;
-}
-
-size_t find_packet_end(const uint8_t* data, const size_t bit_count) {
-	const uint32_t end_code = 0b01111110;
-	const size_t end_code_length = 8;
-
-	bit_history_t<uint32_t> history;
-	for(size_t n=0; n<bit_count; n++) {
-		const size_t byte_index = n >> 3;
-		const size_t bit_index = (n & 7) ^ 7;
-		const uint32_t value = (data[byte_index] >> bit_index) & 1;
-		history.push(value);
-		if( n >= end_code_length ) {
-			if( history.match(end_code, end_code_length) ) {
-				return n + 1 - end_code_length;
-			}
-		}
-	}
-	return 0;
-}
-
-size_t unstuff(uint8_t* data, const size_t bit_count) {
-	const uint32_t stuffing_code = 0b111110;
-	const size_t stuffing_code_length = 6;
-
-	bit_history_t<uint32_t> history;
-	bit_buffer_t buffer(data);
-	for(size_t n=0; n<bit_count; n++) {
-		const size_t byte_index = n >> 3;
-		const size_t bit_index = (n & 7) ^ 7;
-		const uint32_t value = (data[byte_index] >> bit_index) & 1;
-		history.push(value);
-		if( history.match(stuffing_code, stuffing_code_length) ) {
-			// Unstuff this bit.
-		} else {
-			buffer.push(value);
-		}
-	}
-	return buffer.size();
-}
-
 static void console_write_ais_latlon(console_t* const console, const int32_t normalized) {
 	const int32_t t = (normalized * 5) / 3;
 	const int32_t degrees = t / (100 * 10000);
@@ -1178,53 +1250,40 @@ static void console_write_ais_latlon(console_t* const console, const int32_t nor
 }
 
 void handle_command_packet_data_received_ais(const void* const arg) {
+	/* Deframed, unstuffed and CRC-checked on the M4 (see hdlc.h). */
 	ipc_command_packet_data_received_t* const command = (ipc_command_packet_data_received_t*)arg;
+	const size_t byte_count = command->payload_length >> 3;
 
-	const size_t stuffed_length = find_packet_end(command->payload, command->payload_length);
-	if( stuffed_length > 0 ) {
-		const size_t payload_length = unstuff(command->payload, stuffed_length);
-		if( (payload_length >= 16) && ((payload_length & 7) == 0) ) {
-			const size_t byte_count = (payload_length + 7) >> 3;
-			const uint16_t crc_calculated = crc<uint16_t>(command->payload, byte_count - 2) ^ 0xffff;
-			const uint16_t crc_in_packet = (command->payload[byte_count - 2] << 8) | command->payload[byte_count - 1];
-			if( crc_calculated == crc_in_packet ) {
-				for(size_t i=0; i<byte_count - 2; i++) {
-					command->payload[i] = reverse_byte(command->payload[i]);
-				}
-
-				log_timestamp();
-				log_string(" ");
-
-				bit_buffer_t payload(command->payload);
-				const uint8_t message_id = payload.extract(0, 6);
-				console_write_uint32(&console, "%2d:", message_id);
-				if( (message_id > 0) && (message_id < 5) ) {
-					const uint32_t user_id = payload.extract(8, 30);
-					console_write_uint32(&console, "%10d", user_id);
-					
-					int32_t longitude = payload.extract(61, 28) << 4;
-					longitude /= 16;
-					console_write(&console, " ");
-					console_write_ais_latlon(&console, longitude);
-
-					int32_t latitude = payload.extract(89, 27) << 5;
-					latitude /= 32;
-					console_write(&console, " ");
-					console_write_ais_latlon(&console, latitude);
-				} else {
-					for(size_t i=0; i<byte_count - 2; i++) {
-						console_write_uint32(&console, "%01x", command->payload[i] >> 4);
-						console_write_uint32(&console, "%01x", command->payload[i] & 0xf);
-					}
-				}
-
-				log_bytes_hex(command->payload, byte_count - 2);
-				log_string("\n");
+	log_timestamp();
+	log_string(" ");
 
-				console_writeln(&console, "");
-			}
+	bit_buffer_t payload(command->payload);
+	const uint8_t message_id = payload.extract(0, 6);
+	console_write_uint32(&console, "%2d:", message_id);
+	if( (message_id > 0) && (message_id < 5) ) {
+		const uint32_t user_id = payload.extract(8, 30);
+		console_write_uint32(&console, "%10d", user_id);
+		
+		int32_t longitude = payload.extract(61, 28) << 4;
+		longitude /= 16;
+		console_write(&console, " ");
+		console_write_ais_latlon(&console, longitude);
+
+		int32_t latitude = payload.extract(89, 27) << 5;
+		latitude /= 32;
+		console_write(&console, " ");
+		console_write_ais_latlon(&console, latitude);
+	} else {
+		for(size_t i=0; i<byte_count; i++) {
+			console_write_uint32(&console, "%01x", command->payload[i] >> 4);
+			console_write_uint32(&console, "%01x", command->payload[i] & 0xf);
 		}
 	}
+
+	log_bytes_hex(command->payload, byte_count);
+	log_string("\n");
+
+	console_writeln(&console, "");
 }
 
 typedef void (*packet_data_received_handler_fn_t)(const void* const args);
@@ -1234,7 +1293,7 @@ struct receiver_mode_t {
 	packet_data_received_handler_fn_t const packet_data_received_handler;
 };
 
-static const std::array<receiver_mode_t, 7> receiver_modes { {
+static const std::array<receiver_mode_t, 9> receiver_modes { {
 	{ "SPEC", nullptr },
 	{ "NBAM", nullptr },
 	{ "NBFM", nullptr },
@@ -1242,6 +1301,8 @@ static const std::array<receiver_mode_t, 7> receiver_modes { {
 	{ "TPMS-ASK", handle_command_packet_data_received_ask },
 	{ "TPMS-FSK", handle_command_packet_data_received_fsk },
 	{ "AIS", handle_command_packet_data_received_ais },
+	{ "SWEEP", nullptr },
+	{ "ZOOM", nullptr },
 } };
 
 static const void* get_receiver_configuration_name() {
@@ -1260,8 +1321,14 @@ void handle_command_packet_data_received(const void* const arg) {
 }
 
 void handle_command_spectrum_data(const void* const arg) {
+	(void)arg;
+
+	static uint32_t sequence = 0;
+	spectrum_frame_t frame;
+	if( !spectrum_frames_read_latest(&device_state->spectrum_frames, &frame, &sequence) ) {
+		return;
+	}
 
-	const ipc_command_spectrum_data_t* const command = (ipc_command_spectrum_data_t*)arg;
 	const uint_fast16_t draw_y = lcd_scroll(&lcd, 1);
 	const uint_fast16_t x = 0;
 	const uint_fast16_t y = draw_y;
@@ -1269,11 +1336,9 @@ void handle_command_spectrum_data(const void* const arg) {
 	lcd_start_drawing(x, y, lcd.size.w, 1);
 	for(size_t i=0; i<lcd.size.w; i++) {
 		const uint_fast16_t bin = (i + (128 + (256 - 240) / 2)) & 0xff;
-		const lcd_color_t color = spectrum_rgb3_lut[command->avg[bin]];
+		const lcd_color_t color = spectrum_rgb3_lut[frame.avg[bin]];
 		lcd_data_write_rgb(color);
 	}
-
-	ipc_command_spectrum_data_done(&device_state->ipc_m4);
 }
 
 void handle_command_rtc_second(const void* const arg) {
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "log_power.h"
+
+#include <math.h>
+
+/* Uses __builtin_clz rather than __CLZ (it compiles to the same CLZ on the
+ * M4) so that log_power_test can also be built and run on a host.
+ */
+
+/* log2(1 + i/64) in Q16 */
+static const uint32_t log_power_mantissa[65] = {
+	     0,   1466,   2909,   4331,   5732,   7112,   8473,   9814,
+	 11136,  12440,  13727,  14996,  16248,  17484,  18704,  19909,
+	 21098,  22272,  23433,  24579,  25711,  26830,  27936,  29029,
+	 30109,  31178,  32234,  33279,  34312,  35334,  36346,  37346,
+	 38336,  39316,  40286,  41246,  42196,  43137,  44068,  44990,
+	 45904,  46809,  47705,  48593,  49472,  50344,  51207,  52063,
+	 52911,  53751,  54584,  55410,  56229,  57040,  57845,  58643,
+	 59434,  60219,  60997,  61769,  62534,  63294,  64047,  64794,
+	 65536
+};
+
+void log_power_init(log_power_state_t* const state, const float scale, const int frac_bits, const float floor, const float gain) {
+	const float log10_2 = 0.30102999566398120f;
+	state->offset = (int32_t)lroundf((log2f(scale) - frac_bits - floor / log10_2) * 65536.0f);
+	state->gain = (int32_t)lroundf(gain * log10_2 * 65536.0f);
+}
+
+/* m is normalized (bit 31 set), exponent is the position of that bit in
+ * the original value.
+ */
+static inline uint32_t log_power_quantize(const log_power_state_t* const state, const uint32_t m, const int32_t exponent) {
+	const uint32_t i = (m >> 25) & 63;
+	const uint32_t f = (m >> 9) & 0xffff;
+	const uint32_t t0 = log_power_mantissa[i];
+	const uint32_t t1 = log_power_mantissa[i + 1];
+	const int32_t log2_q16 = (exponent << 16) + t0 + (((t1 - t0) * f) >> 16);
+
+	const int32_t n = (((int64_t)(log2_q16 + state->offset) * state->gain) + (1LL << 31)) >> 32;
+	if( n < 0 ) {
+		return 0;
+	}
+	if( n > 255 ) {
+		return 255;
+	}
+	return n;
+}
+
+void log_power_u32_u8(const log_power_state_t* const state, const uint32_t* const src, uint8_t* const dst, const size_t n) {
+	for(size_t i=0; i<n; i++) {
+		const uint32_t x = src[i];
+		if( x == 0 ) {
+			dst[i] = 0;
+			continue;
+		}
+		const uint32_t z = __builtin_clz(x);
+		dst[i] = log_power_quantize(state, x << z, 31 - z);
+	}
+}
+
+void log_power_u64_u8(const log_power_state_t* const state, const uint64_t* const src, uint8_t* const dst, const size_t n) {
+	for(size_t i=0; i<n; i++) {
+		const uint32_t x_hi = src[i] >> 32;
+		const uint32_t x_lo = src[i];
+		if( x_hi == 0 ) {
+			if( x_lo == 0 ) {
+				dst[i] = 0;
+				continue;
+			}
+			const uint32_t z = __builtin_clz(x_lo);
+			dst[i] = log_power_quantize(state, x_lo << z, 31 - z);
+		} else {
+			const uint32_t z = __builtin_clz(x_hi);
+			const uint32_t m = z ? ((x_hi << z) | (x_lo >> (32 - z))) : x_hi;
+			dst[i] = log_power_quantize(state, m, 63 - z);
+		}
+	}
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __LOG_POWER_H__
+#define __LOG_POWER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Power to display byte, without floating point:
+ *
+ *   dst = clamp(round((log10(src / 2^frac_bits * scale) - floor) * gain), 0, 255)
+ *
+ * log2 comes from CLZ plus an interpolated 64-entry mantissa table, so the
+ * result is within one output step of the log10f() version for any
+ * reasonable gain. Zero input maps to 0.
+ */
+typedef struct log_power_state_t {
+	int32_t offset;		/* Q16 log2 units */
+	int32_t gain;		/* Q16 output steps per log2 unit */
+} log_power_state_t;
+
+void log_power_init(log_power_state_t* const state, const float scale, const int frac_bits, const float floor, const float gain);
+
+void log_power_u32_u8(const log_power_state_t* const state, const uint32_t* const src, uint8_t* const dst, const size_t n);
+void log_power_u64_u8(const log_power_state_t* const state, const uint64_t* const src, uint8_t* const dst, const size_t n);
+
+#endif/*__LOG_POWER_H__*/
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Also runs on a host:
+ *   g++ -DLOG_POWER_TEST_HOST log_power_test.cpp log_power.cpp -o log_power_test
+ */
+
+#include "log_power_test.h"
+
+#include "log_power.h"
+
+#include <stdint.h>
+#include <math.h>
+
+#include <algorithm>
+
+/* The float mapping specan used before the fixed-point kernel. */
+static uint8_t reference_log_power(const double x, const float scale, const float floor, const float gain) {
+	if( x == 0 ) {
+		return 0;
+	}
+	const float x_log = log10f(x * scale);
+	const int n = (int)roundf((x_log - floor) * gain);
+	return std::max(std::min(n, 255), 0);
+}
+
+static int within_one_step(const uint8_t a, const uint8_t b) {
+	return (a > b) ? ((a - b) <= 1) : ((b - a) <= 1);
+}
+
+static int test_log_power_u32_u8() {
+	/* specan peak mapping: mag_2_scale for 16 frames, floor -4.5, gain 50 */
+	const float mag_scale = 2.0f * 0.7071067811865476f / (256.0f * 16);
+	const float scale = mag_scale * mag_scale;
+
+	log_power_state_t state;
+	log_power_init(&state, scale, 0, -4.5f, 50.0f);
+
+	uint32_t x = 0;
+	for(size_t i=0; i<4096; i++) {
+		uint8_t actual;
+		log_power_u32_u8(&state, &x, &actual, 1);
+		if( !within_one_step(actual, reference_log_power(x, scale, -4.5f, 50.0f)) ) {
+			return 0;
+		}
+		x = x + (x >> 3) + 1;
+	}
+
+	return 1;
+}
+
+static int test_log_power_u64_u8() {
+	/* specan average mapping: 128 FFTs summed, with two fractional bits */
+	const float mag_scale = 2.0f * 0.7071067811865476f / 256.0f;
+	const float scale = mag_scale * mag_scale / 128.0f;
+
+	log_power_state_t state;
+	log_power_init(&state, scale, 2, -4.5f, 50.0f);
+
+	uint64_t x = 1;
+	for(size_t i=0; i<4096; i++) {
+		uint8_t actual;
+		log_power_u64_u8(&state, &x, &actual, 1);
+		if( !within_one_step(actual, reference_log_power(x / 4.0, scale, -4.5f, 50.0f)) ) {
+			return 0;
+		}
+		x = x + (x >> 4) + 3;
+		if( x >> 62 ) {
+			x = i;
+		}
+	}
+
+	return 1;
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void log_power_test() {
+	halt_if_failed(test_log_power_u32_u8());
+	halt_if_failed(test_log_power_u64_u8());
+}
+
+#ifdef LOG_POWER_TEST_HOST
+int main() {
+	return (test_log_power_u32_u8() && test_log_power_u64_u8()) ? 0 : 1;
+}
+#endif
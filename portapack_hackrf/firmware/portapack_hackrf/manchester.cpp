@@ -23,33 +23,139 @@
 
 #include <stdint.h>
 
+#include "index_list.h"
+
+static constexpr uint32_t manchester_pair(const size_t b, const size_t k) {
+	return (b >> (6 - 2 * k)) & 3;
+}
+
+static constexpr uint32_t manchester_error(const size_t b, const size_t k) {
+	return ((manchester_pair(b, k) == 0b00) || (manchester_pair(b, k) == 0b11)) ? 1 : 0;
+}
+
+static constexpr uint32_t manchester_data(const size_t b, const size_t k, const bool differential) {
+	return differential ?
+		(((manchester_pair(b, k) >> 1) == ((k == 0) ? 0 : (manchester_pair(b, k - 1) & 1))) ? 1 : 0) :
+		(manchester_pair(b, k) & 1);
+}
+
+/* Data nibble in the top four bits, errors in the bottom four. */
+static constexpr uint8_t manchester_entry(const size_t b, const bool differential) {
+	return
+		(manchester_data(b, 0, differential) << 7) | (manchester_data(b, 1, differential) << 6) |
+		(manchester_data(b, 2, differential) << 5) | (manchester_data(b, 3, differential) << 4) |
+		(manchester_error(b, 0) << 3) | (manchester_error(b, 1) << 2) |
+		(manchester_error(b, 2) << 1) | (manchester_error(b, 3) << 0);
+}
+
+template<typename List>
+struct manchester_tables;
+
+/* differential assumes a preceding 0; after a 1 only the first bit flips. */
+template<size_t... I>
+struct manchester_tables<index_list<I...>> {
+	static constexpr uint8_t ieee[sizeof...(I)] = { manchester_entry(I, false)... };
+	static constexpr uint8_t differential[sizeof...(I)] = { manchester_entry(I, true)... };
+};
+
+template<size_t... I>
+constexpr uint8_t manchester_tables<index_list<I...>>::ieee[sizeof...(I)];
+template<size_t... I>
+constexpr uint8_t manchester_tables<index_list<I...>>::differential[sizeof...(I)];
+
+typedef manchester_tables<make_index_list<256>::type> manchester_tables_256;
+
+static inline uint32_t manchester_decode_byte(
+	manchester_decoder_t* const decoder,
+	const uint32_t symbols
+) {
+	uint32_t entry;
+	switch(decoder->format) {
+	case MANCHESTER_THOMAS:
+		entry = manchester_tables_256::ieee[symbols] ^ 0xf0;
+		break;
+
+	case MANCHESTER_DIFFERENTIAL:
+		entry = manchester_tables_256::differential[symbols] ^ (decoder->previous << 7);
+		break;
+
+	default:
+		entry = manchester_tables_256::ieee[symbols];
+		break;
+	}
+	decoder->previous = symbols & 1;
+	return entry;
+}
+
+void manchester_decoder_init(
+	manchester_decoder_t* const decoder,
+	const manchester_format_t format
+) {
+	decoder->format = format;
+	decoder->previous = 0;
+	decoder->bits_decoded = 0;
+}
+
+uint32_t manchester_decoder_execute_u16(
+	manchester_decoder_t* const decoder,
+	const uint32_t symbols
+) {
+	const uint32_t hi = manchester_decode_byte(decoder, (symbols >> 8) & 0xff);
+	const uint32_t lo = manchester_decode_byte(decoder, symbols & 0xff);
+	decoder->bits_decoded += 8;
+	return ((hi & 0xf0) << 8) | ((lo & 0xf0) << 4) | ((hi & 0x0f) << 4) | (lo & 0x0f);
+}
+
+void manchester_decoder_execute(
+	manchester_decoder_t* const decoder,
+	const uint8_t* const in,
+	const size_t in_length,
+	uint8_t* const out,
+	uint8_t* const errors
+) {
+	size_t i = 0;
+
+	/* Finish a half-filled output byte first. */
+	if( (i < in_length) && (decoder->bits_decoded & 4) ) {
+		const size_t index = decoder->bits_decoded >> 3;
+		const uint32_t entry = manchester_decode_byte(decoder, in[i++]);
+		out[index] = (out[index] & 0xf0) | (entry >> 4);
+		errors[index] = (errors[index] & 0xf0) | (entry & 0x0f);
+		decoder->bits_decoded += 4;
+	}
+
+	/* Then whole output bytes, no read-modify-write. */
+	for(; (i+2)<=in_length; i+=2) {
+		const size_t index = decoder->bits_decoded >> 3;
+		const uint32_t decoded = manchester_decoder_execute_u16(decoder, (in[i] << 8) | in[i+1]);
+		out[index] = decoded >> 8;
+		errors[index] = decoded & 0xff;
+	}
+
+	if( i < in_length ) {
+		const size_t index = decoder->bits_decoded >> 3;
+		const uint32_t entry = manchester_decode_byte(decoder, in[i]);
+		out[index] = entry & 0xf0;
+		errors[index] = entry << 4;
+		decoder->bits_decoded += 4;
+	}
+}
+
 void manchester_decode(
 	const uint8_t* const in,
 	uint8_t* const out,
 	uint8_t* const errors,
-	const size_t out_bits
+	const size_t out_bits,
+	const manchester_format_t format
 ) {
-	for(size_t out_bit_n=0; out_bit_n<out_bits; out_bit_n++) {
-		const size_t in_word_index = out_bit_n >> 2;
-		const size_t in_bit_index = ((out_bit_n & 3) ^ 3) << 1;
-		const uint_fast8_t in_symbol = (in[in_word_index] >> in_bit_index) & 3;
-
-		const uint_fast8_t out_symbol = in_symbol & 1;
-		const uint_fast8_t out_error = (in_symbol == 0b00) | (in_symbol == 0b11);
-		const size_t out_word_index = out_bit_n >> 3;
-		const size_t out_bit_index = (out_bit_n & 7) ^ 7;
-		const uint8_t out_bit = (1 << out_bit_index);
-		
-		if( out_symbol ) {
-			out[out_word_index] |= out_bit;
-		} else {
-			out[out_word_index] &= ~out_bit;
-		}
-		
-		if( out_error ) {
-			errors[out_word_index] |= out_bit;
-		} else {
-			errors[out_word_index] &= ~out_bit;
-		}
+	manchester_decoder_t decoder;
+	manchester_decoder_init(&decoder, format);
+	manchester_decoder_execute(&decoder, in, (out_bits + 3) >> 2, out, errors);
+
+	if( out_bits & 7 ) {
+		const size_t index = out_bits >> 3;
+		const uint8_t mask = 0xff << (8 - (out_bits & 7));
+		out[index] &= mask;
+		errors[index] &= mask;
 	}
 }
@@ -25,12 +25,63 @@
 #include <stdint.h>
 #include <stddef.h>
 
-/* IEEE 802.3 style Manchester decoding */
+/* Each data bit is two symbols, packed MSB first, four bits to a byte:
+ *
+ *   MANCHESTER_IEEE_802_3: 01 is 1, 10 is 0
+ *   MANCHESTER_THOMAS: 10 is 1, 01 is 0 (G. E. Thomas)
+ *   MANCHESTER_DIFFERENTIAL: no transition at the start of the bit is 1,
+ *     a transition is 0; the first bit is against a preceding 0.
+ *
+ * 00 and 11 have no mid-bit transition and set the bit in errors.
+ * Decoding is a table lookup per input byte, two per output byte.
+ */
+typedef enum {
+	MANCHESTER_IEEE_802_3 = 0,
+	MANCHESTER_THOMAS = 1,
+	MANCHESTER_DIFFERENTIAL = 2,
+} manchester_format_t;
+
+/* Whole packet. Bits in the last bytes of out and errors beyond out_bits
+ * are cleared.
+ */
 void manchester_decode(
 	const uint8_t* const in,
 	uint8_t* const out,
 	uint8_t* const errors,
-	const size_t out_bits
+	const size_t out_bits,
+	const manchester_format_t format
+);
+
+/* Streaming: symbols arrive a byte at a time (or more), and decoded bits
+ * are appended to out and errors.
+ *
+ * manchester.cpp is built for both cores: the TPMS receivers on the M4
+ * use manchester_decode() to score candidate packets, and the M0 decodes
+ * what they deliver.
+ */
+typedef struct manchester_decoder_t {
+	manchester_format_t format;
+	uint32_t previous;
+	size_t bits_decoded;
+} manchester_decoder_t;
+
+void manchester_decoder_init(
+	manchester_decoder_t* const decoder,
+	const manchester_format_t format
+);
+
+void manchester_decoder_execute(
+	manchester_decoder_t* const decoder,
+	const uint8_t* const in,
+	const size_t in_length,
+	uint8_t* const out,
+	uint8_t* const errors
+);
+
+/* Eight symbol pairs in, (data << 8) | errors out. */
+uint32_t manchester_decoder_execute_u16(
+	manchester_decoder_t* const decoder,
+	const uint32_t symbols
 );
 
 #endif/*__MANCHESTER_H__*/
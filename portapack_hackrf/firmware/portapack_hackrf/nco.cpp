@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "nco.h"
+
+#include "arm_intrinsics.h"
+
+#include "sin_table.h"
+
+#define NCO_TABLE_SIZE 1024
+#define NCO_TABLE_SHIFT (32 - 10)
+
+static_assert((1 << (32 - NCO_TABLE_SHIFT)) == NCO_TABLE_SIZE, "NCO table size and shift disagree");
+
+/* Packed sin:cos words, laid out so that with a Q:I sample x
+ *   SMUSD(x, w)  = I * cos - Q * sin = real(x * e^(j*theta))
+ *   SMUADX(x, w) = I * sin + Q * cos = imag(x * e^(j*theta))
+ */
+template<typename List>
+struct nco_table;
+
+template<size_t... I>
+struct nco_table<index_list<I...>> {
+	static constexpr uint32_t sin_cos[sizeof...(I)] = {
+		((uint32_t)(uint16_t)sin_q15(sin_turn(I, NCO_TABLE_SIZE)) << 16) |
+		(uint16_t)sin_q15(sin_turn(I + NCO_TABLE_SIZE / 4, NCO_TABLE_SIZE))...
+	};
+};
+
+template<size_t... I>
+constexpr uint32_t nco_table<index_list<I...>>::sin_cos[sizeof...(I)];
+
+typedef nco_table<make_index_list<NCO_TABLE_SIZE>::type> nco_table_1024;
+
+uint32_t nco_phase_increment(const int32_t frequency_hz, const uint32_t sampling_rate) {
+	/* Negative frequencies wrap around to the top of the phase circle. */
+	return (uint32_t)(((int64_t)frequency_hz * (1LL << 32)) / (int64_t)sampling_rate);
+}
+
+void nco_cplx_s16_s16_init(nco_cplx_s16_s16_state_t* const state, const int32_t frequency_hz, const uint32_t sampling_rate) {
+	/* Half a table step in, so truncating the phase to a table index
+	 * rounds it instead.
+	 */
+	state->phase = 1 << (NCO_TABLE_SHIFT - 1);
+	nco_cplx_s16_s16_set_frequency(state, frequency_hz, sampling_rate);
+}
+
+void nco_cplx_s16_s16_set_frequency(nco_cplx_s16_s16_state_t* const state, const int32_t frequency_hz, const uint32_t sampling_rate) {
+	state->phase_increment = nco_phase_increment(frequency_hz, sampling_rate);
+}
+
+size_t nco_cplx_s16_s16(
+	nco_cplx_s16_s16_state_t* const state,
+	const complex_s16_t* const src,
+	complex_s16_t* const dst,
+	const size_t sample_count
+) {
+	/* Two samples per iteration, one table load and one complex multiply
+	 * (SMUSD + SMUADX) each. The Q30 products are packed back to Q:I with
+	 * one PKHTB: bits 30..15 of imag go to the top half by shifting left
+	 * one, bits 30..15 of real to the bottom half with ASR 15.
+	 */
+	const uint32_t* const sin_cos = nco_table_1024::sin_cos;
+	const uint32_t phase_increment = state->phase_increment;
+	uint32_t phase = state->phase;
+	const uint32_t* s = (const uint32_t*)src;
+	uint32_t* d = (uint32_t*)dst;
+
+	int32_t n = sample_count;
+	for(; n>1; n-=2) {
+		const uint32_t x0 = *(s++);							/* 2: Q0:I0 */
+		const uint32_t x1 = *(s++);							/*    Q1:I1 */
+		const uint32_t w0 = sin_cos[phase >> NCO_TABLE_SHIFT];	/* 2: sin:cos */
+		phase += phase_increment;							/* 1 */
+		const uint32_t w1 = sin_cos[phase >> NCO_TABLE_SHIFT];	/* 2 */
+		phase += phase_increment;							/* 1 */
+		const uint32_t i0 = __SMUSD(x0, w0);				/* 1: I*cos - Q*sin */
+		const uint32_t q0 = __SMUADX(x0, w0);				/* 1: I*sin + Q*cos */
+		const uint32_t i1 = __SMUSD(x1, w1);				/* 1 */
+		const uint32_t q1 = __SMUADX(x1, w1);				/* 1 */
+		*(d++) = __PKHTB(q0 << 1, i0, 15);					/* 2: Q:I */
+		*(d++) = __PKHTB(q1 << 1, i1, 15);					/* 2 */
+	}
+	if( n > 0 ) {
+		const uint32_t x0 = *(s++);
+		const uint32_t w0 = sin_cos[phase >> NCO_TABLE_SHIFT];
+		phase += phase_increment;
+		*(d++) = __PKHTB(__SMUADX(x0, w0) << 1, __SMUSD(x0, w0), 15);
+	}
+	state->phase = phase;
+
+	return sample_count;
+}
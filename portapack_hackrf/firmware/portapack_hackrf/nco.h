@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __NCO_H__
+#define __NCO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "complex.h"
+
+/* Complex mixer: multiplies complex<int16_t> samples by e^(j*phase), with
+ * the phase advanced by a fixed increment per sample. Shifts the spectrum
+ * up by frequency_hz (down, if negative).
+ *
+ * The sinusoid comes from a 1024-entry packed sin:cos Q15 table indexed by
+ * the top ten bits of a 32-bit phase accumulator, so spurs sit about 56dB
+ * below the carrier. Frequency resolution is sampling_rate / 2^32.
+ */
+uint32_t nco_phase_increment(const int32_t frequency_hz, const uint32_t sampling_rate);
+
+typedef struct nco_cplx_s16_s16_state_t {
+	uint32_t phase;
+	uint32_t phase_increment;
+} nco_cplx_s16_s16_state_t;
+
+void nco_cplx_s16_s16_init(nco_cplx_s16_s16_state_t* const state, const int32_t frequency_hz, const uint32_t sampling_rate);
+
+/* Changes frequency without a phase jump. */
+void nco_cplx_s16_s16_set_frequency(nco_cplx_s16_s16_state_t* const state, const int32_t frequency_hz, const uint32_t sampling_rate);
+
+/* May run in place. Output magnitude equals input magnitude (within
+ * rounding), so input magnitude must not exceed 32767.
+ */
+size_t nco_cplx_s16_s16(
+	nco_cplx_s16_s16_state_t* const state,
+	const complex_s16_t* const src,
+	complex_s16_t* const dst,
+	const size_t sample_count
+);
+
+#endif/*__NCO_H__*/
@@ -21,8 +21,6 @@
 
 #include "packet_builder.h"
 
-#include "portapack.h"
-
 void packet_builder_init(
 	packet_builder_t* const packet_builder,
 	const size_t payload_length,
@@ -31,46 +29,212 @@ void packet_builder_init(
 ) {
 	packet_builder->payload_length = payload_length;
 	packet_builder->bits_received = 0;
+	packet_builder->start_symbol = 0;
 	packet_builder->state = PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH;
 	packet_builder->payload_handler = payload_handler;
 	packet_builder->context = context;
-	for(size_t i=0; i<ARRAY_SIZE(packet_builder->payload); i++) {
+	for(size_t i=0; i<sizeof(packet_builder->payload); i++) {
 		packet_builder->payload[i] = 0;
 	}
 }
 
-void packet_builder_execute(
+static inline uint32_t packet_builder_shift(const uint32_t value, const size_t count) {
+	return (count < 32) ? (value << count) : 0;
+}
+
+static void packet_builder_append(
 	packet_builder_t* const packet_builder,
-	const uint_fast8_t symbol,
-	const bool access_code_found
+	uint32_t bits,
+	size_t count
+) {
+	while(count > 0) {
+		const size_t byte_index = packet_builder->bits_received >> 3;
+		const size_t bit_offset = packet_builder->bits_received & 7;
+		const size_t n = (count < (8 - bit_offset)) ? count : (8 - bit_offset);
+
+		/* Bits below the write position were cleared when the byte was started. */
+		const uint8_t head = (bit_offset == 0) ? 0 : packet_builder->payload[byte_index];
+		const uint8_t new_bits = ((bits >> 24) & (0xff00 >> n)) >> bit_offset;
+		packet_builder->payload[byte_index] = head | new_bits;
+
+		bits <<= n;
+		count -= n;
+		packet_builder->bits_received += n;
+	}
+}
+
+/* Feeds candidate i, in PAYLOAD state, the top symbol_count symbols or
+ * as many as it still needs. A finished payload is scored, then dropped
+ * or held until the candidates overlapping it have finished too.
+ */
+static void packet_builder_pool_collect(
+	packet_builder_pool_t* const pool,
+	const size_t i,
+	const uint32_t symbols,
+	const size_t symbol_count
+) {
+	packet_builder_t* const builder = &pool->builders[i];
+	const size_t needed = builder->payload_length - builder->bits_received;
+	packet_builder_append(builder, symbols, (symbol_count < needed) ? symbol_count : needed);
+
+	if( builder->bits_received == builder->payload_length ) {
+		pool->score[i] = pool->payload_score ? pool->payload_score(&builder->payload, builder->bits_received, builder->context) : 0;
+		builder->state = (pool->score[i] < 0) ? PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH : PACKET_BUILDER_STATE_COMPLETE;
+	}
+}
+
+/* Stream positions compared as a signed difference, so the symbol
+ * counter can wrap.
+ */
+static inline bool packet_builder_pool_before(const uint32_t a, const uint32_t b) {
+	return (int32_t)(a - b) < 0;
+}
+
+static bool packet_builder_pool_better(
+	const packet_builder_pool_t* const pool,
+	const size_t i,
+	const size_t j
+) {
+	/* A shifted preamble can still score well, so the access code goes first. */
+	if( pool->access_code_distance[i] != pool->access_code_distance[j] ) {
+		return pool->access_code_distance[i] < pool->access_code_distance[j];
+	}
+	if( pool->score[i] != pool->score[j] ) {
+		return pool->score[i] < pool->score[j];
+	}
+	/* Hits in the preamble come before the real one. */
+	return packet_builder_pool_before(pool->builders[j].start_symbol, pool->builders[i].start_symbol);
+}
+
+/* A free builder, else the candidate with the worst access code distance
+ * (the oldest of those) if the new hit is no worse. Returns
+ * PACKET_BUILDER_POOL_SIZE to drop the new hit.
+ */
+static size_t packet_builder_pool_claim(
+	const packet_builder_pool_t* const pool,
+	const size_t access_code_distance
+) {
+	size_t victim = PACKET_BUILDER_POOL_SIZE;
+	for(size_t i=0; i<PACKET_BUILDER_POOL_SIZE; i++) {
+		if( pool->builders[i].state == PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH ) {
+			return i;
+		}
+		if( (victim == PACKET_BUILDER_POOL_SIZE) ||
+			(pool->access_code_distance[i] > pool->access_code_distance[victim]) ||
+			((pool->access_code_distance[i] == pool->access_code_distance[victim]) &&
+			 packet_builder_pool_before(pool->builders[i].start_symbol, pool->builders[victim].start_symbol)) ) {
+			victim = i;
+		}
+	}
+	return (pool->access_code_distance[victim] < access_code_distance) ? PACKET_BUILDER_POOL_SIZE : victim;
+}
+
+/* Delivers the oldest group of overlapping candidates once all of them
+ * are complete, and repeats; stops at a group that is still collecting.
+ */
+static void packet_builder_pool_deliver(
+	packet_builder_pool_t* const pool
 ) {
-	switch(packet_builder->state) {
-	case PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH:
-		if( access_code_found ) {
-			packet_builder->state = PACKET_BUILDER_STATE_PAYLOAD;
-			packet_builder->bits_received = 0;
+	while(true) {
+		size_t oldest = PACKET_BUILDER_POOL_SIZE;
+		for(size_t i=0; i<PACKET_BUILDER_POOL_SIZE; i++) {
+			packet_builder_t* const builder = &pool->builders[i];
+			if( builder->state == PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH ) {
+				continue;
+			}
+			/* Started inside a packet already delivered. */
+			if( packet_builder_pool_before(builder->start_symbol, pool->delivered_end) ) {
+				builder->state = PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH;
+				continue;
+			}
+			if( (oldest == PACKET_BUILDER_POOL_SIZE) ||
+				packet_builder_pool_before(builder->start_symbol, pool->builders[oldest].start_symbol) ) {
+				oldest = i;
+			}
+		}
+		if( (oldest == PACKET_BUILDER_POOL_SIZE) || (pool->builders[oldest].state != PACKET_BUILDER_STATE_COMPLETE) ) {
+			return;
 		}
-		break;
-
-	case PACKET_BUILDER_STATE_PAYLOAD:
-		if( packet_builder->bits_received < packet_builder->payload_length ) {
-			const size_t byte_index = packet_builder->bits_received >> 3;
-			const size_t bit_index = (packet_builder->bits_received & 7) ^ 7;
-			const uint8_t bit = 1 << bit_index;
-			if( symbol ) {
-				packet_builder->payload[byte_index] |= bit;
-			} else {
-				packet_builder->payload[byte_index] &= ~bit;
+
+		const uint32_t oldest_end = pool->builders[oldest].start_symbol + pool->builders[oldest].payload_length;
+		size_t best = oldest;
+		for(size_t i=0; i<PACKET_BUILDER_POOL_SIZE; i++) {
+			const packet_builder_t* const builder = &pool->builders[i];
+			if( (builder->state == PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH) ||
+				!packet_builder_pool_before(builder->start_symbol, oldest_end) ) {
+				continue;
+			}
+			if( builder->state == PACKET_BUILDER_STATE_PAYLOAD ) {
+				return;
+			}
+			if( packet_builder_pool_better(pool, i, best) ) {
+				best = i;
 			}
-			packet_builder->bits_received += 1;
-		} else {
-			packet_builder->payload_handler(&packet_builder->payload, packet_builder->bits_received, packet_builder->context);
-			packet_builder->state = PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH;
 		}
-		break;
 
-	default:
-		packet_builder->state = PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH;
-		break;
+		packet_builder_t* const delivered = &pool->builders[best];
+		delivered->payload_handler(&delivered->payload, delivered->bits_received, delivered->start_symbol, delivered->context);
+		pool->delivered_end = delivered->start_symbol + delivered->payload_length;
+		delivered->state = PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH;
 	}
 }
+
+void packet_builder_pool_init(
+	packet_builder_pool_t* const pool,
+	const size_t payload_length,
+	packet_builder_payload_handler_t payload_handler,
+	packet_builder_payload_score_t payload_score,
+	void* const context
+) {
+	for(size_t i=0; i<PACKET_BUILDER_POOL_SIZE; i++) {
+		packet_builder_init(&pool->builders[i], payload_length, payload_handler, context);
+		pool->access_code_distance[i] = 0;
+		pool->score[i] = 0;
+	}
+	pool->payload_score = payload_score;
+	pool->symbols_received = 0;
+	pool->delivered_end = 0;
+}
+
+void packet_builder_pool_execute_word(
+	packet_builder_pool_t* const pool,
+	const uint32_t symbols,
+	const size_t symbol_count,
+	const uint32_t access_code_hits,
+	const access_code_correlator_t* const correlator
+) {
+	for(size_t i=0; i<PACKET_BUILDER_POOL_SIZE; i++) {
+		if( pool->builders[i].state == PACKET_BUILDER_STATE_PAYLOAD ) {
+			packet_builder_pool_collect(pool, i, symbols, symbol_count);
+		}
+	}
+
+	uint32_t hits = access_code_hits & (0xffffffff << (32 - symbol_count));
+	while( hits ) {
+		const size_t position = __builtin_clz(hits);
+		hits &= ~(0x80000000U >> position);
+
+		/* Payload starts with the symbol after the access code. */
+		const size_t consumed = position + 1;
+		const uint32_t start_symbol = pool->symbols_received + consumed;
+		if( packet_builder_pool_before(start_symbol, pool->delivered_end) ) {
+			continue;
+		}
+
+		const size_t distance = access_code_correlator_distance(correlator, symbol_count, position);
+		const size_t i = packet_builder_pool_claim(pool, distance);
+		if( i == PACKET_BUILDER_POOL_SIZE ) {
+			continue;
+		}
+
+		packet_builder_t* const builder = &pool->builders[i];
+		builder->state = PACKET_BUILDER_STATE_PAYLOAD;
+		builder->bits_received = 0;
+		builder->start_symbol = start_symbol;
+		pool->access_code_distance[i] = distance;
+		packet_builder_pool_collect(pool, i, packet_builder_shift(symbols, consumed), symbol_count - consumed);
+	}
+
+	pool->symbols_received += symbol_count;
+	packet_builder_pool_deliver(pool);
+}
@@ -26,16 +26,21 @@
 #include <stddef.h>
 #include <stdbool.h>
 
+#include "access_code_correlator.h"
+
 typedef enum {
 	PACKET_BUILDER_STATE_ACCESS_CODE_SEARCH = 0,
 	PACKET_BUILDER_STATE_PAYLOAD = 1,
+	PACKET_BUILDER_STATE_COMPLETE = 2,
 } packet_builder_state_t;
 
-typedef void (*packet_builder_payload_handler_t)(const void* const payload, const size_t payload_length, void* const context);
+/* start_symbol: stream position of the first payload symbol, counted from init. */
+typedef void (*packet_builder_payload_handler_t)(const void* const payload, const size_t payload_length, const uint32_t start_symbol, void* const context);
 
 typedef struct packet_builder_t {
 	size_t payload_length;
 	size_t bits_received;
+	uint32_t start_symbol;
 	packet_builder_state_t state;
 	packet_builder_payload_handler_t payload_handler;
 	void* context;
@@ -49,10 +54,51 @@ void packet_builder_init(
 	void* const context
 );
 
-void packet_builder_execute(
-	packet_builder_t* const packet_builder,
-	const uint_fast8_t symbol,
-	const bool access_code_found
+/* Several builders fed from one symbol stream. Every access code hit
+ * starts a candidate, even while others are still collecting, so a
+ * false hit in a long preamble doesn't hide the real packet that starts
+ * a few symbols later. With all builders busy, a new hit replaces the
+ * candidate with the worst access code distance, the oldest of those.
+ *
+ * Each complete payload is scored by the receiver: a negative score
+ * drops it, otherwise lower is better. Of the candidates that overlap,
+ * only one is delivered: the closest access code, then the lowest
+ * score, then the latest start. Packets are delivered in start order,
+ * up to one payload length late.
+ */
+#define PACKET_BUILDER_POOL_SIZE 4
+
+typedef int32_t (*packet_builder_payload_score_t)(const void* const payload, const size_t payload_length, void* const context);
+
+typedef struct packet_builder_pool_t {
+	packet_builder_t builders[PACKET_BUILDER_POOL_SIZE];
+	size_t access_code_distance[PACKET_BUILDER_POOL_SIZE];
+	int32_t score[PACKET_BUILDER_POOL_SIZE];
+	packet_builder_payload_score_t payload_score;
+	uint32_t symbols_received;
+	uint32_t delivered_end;
+} packet_builder_pool_t;
+
+/* payload_score may be NULL to keep every payload. */
+void packet_builder_pool_init(
+	packet_builder_pool_t* const pool,
+	const size_t payload_length,
+	packet_builder_payload_handler_t payload_handler,
+	packet_builder_payload_score_t payload_score,
+	void* const context
+);
+
+/* Up to 32 symbols at once, packed first symbol in bit 31, with the
+ * matching hits from access_code_correlator_execute_word() on correlator,
+ * which is asked for the distance of each hit. Payload bits are copied
+ * up to a byte at a time.
+ */
+void packet_builder_pool_execute_word(
+	packet_builder_pool_t* const pool,
+	const uint32_t symbols,
+	const size_t symbol_count,
+	const uint32_t access_code_hits,
+	const access_code_correlator_t* const correlator
 );
 
 #endif/*__PACKET_BUILDER_H__*/
@@ -0,0 +1,353 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Also runs on a host:
+ *   g++ -DPACKET_BUILDER_TEST_HOST packet_builder_test.cpp packet_builder.cpp access_code_correlator.cpp -o packet_builder_test
+ */
+
+#include "packet_builder_test.h"
+
+#include "access_code_correlator.h"
+#include "packet_builder.h"
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct packet_digest_t {
+	uint32_t hash;
+	size_t count;
+} packet_digest_t;
+
+static void packet_digest_add(
+	packet_digest_t* const digest,
+	const uint8_t* const payload,
+	const size_t payload_length,
+	const uint32_t start_symbol
+) {
+	uint32_t h = digest->hash ^ start_symbol;
+	h = (h ^ payload_length) * 16777619;
+	for(size_t i=0; i<(payload_length + 7) / 8; i++) {
+		h = (h ^ payload[i]) * 16777619;
+	}
+	digest->hash = h;
+	digest->count += 1;
+}
+
+static uint32_t next_random(uint32_t* const x) {
+	*x = *x * 1103515245 + 12345;
+	return *x >> 16;
+}
+
+/* Random bits with the access code dropped in now and then, a few of
+ * its bits flipped. Returns one symbol per call.
+ */
+typedef struct symbol_source_t {
+	uint32_t x;
+	uint64_t code;
+	size_t code_length;
+	size_t code_remaining;
+} symbol_source_t;
+
+static uint_fast8_t symbol_source_next(symbol_source_t* const source) {
+	if( (source->code_remaining == 0) && ((next_random(&source->x) % 300) == 0) ) {
+		source->code_remaining = source->code_length;
+	}
+	if( source->code_remaining > 0 ) {
+		source->code_remaining -= 1;
+		const uint_fast8_t flip = ((next_random(&source->x) % 40) == 0) ? 1 : 0;
+		return ((source->code >> source->code_remaining) & 1) ^ flip;
+	}
+	return next_random(&source->x) & 1;
+}
+
+/* One symbol at a time, straight from the definition. */
+typedef struct reference_correlator_t {
+	uint64_t code;
+	uint64_t mask;
+	uint64_t history;
+	size_t maximum_hamming_distance;
+} reference_correlator_t;
+
+static bool reference_correlator_execute(
+	reference_correlator_t* const r,
+	const uint_fast8_t symbol
+) {
+	r->history = (r->history << 1) | symbol;
+	return (size_t)__builtin_popcountll((r->history ^ r->code) & r->mask) <= r->maximum_hamming_distance;
+}
+
+static int test_word_matches_reference(
+	const uint64_t code,
+	const size_t code_length,
+	const size_t maximum_hamming_distance,
+	const uint32_t seed
+) {
+	reference_correlator_t reference = {
+		code, (code_length < 64) ? ((1ULL << code_length) - 1) : ~0ULL, 0,
+		maximum_hamming_distance
+	};
+
+	access_code_correlator_t correlator;
+	access_code_correlator_init(&correlator, code, code_length, maximum_hamming_distance);
+
+	symbol_source_t source = { seed, code, code_length, 0 };
+	uint32_t chunk_random = seed;
+	size_t hit_count = 0;
+
+	/* Word sizes vary so hits straddle every boundary. */
+	for(size_t n=0; n<8192; ) {
+		const size_t symbol_count = 1 + (next_random(&chunk_random) % 32);
+		uint32_t symbols = 0;
+		uint32_t expected_hits = 0;
+		for(size_t k=0; k<symbol_count; k++) {
+			const uint_fast8_t symbol = symbol_source_next(&source);
+			symbols |= (uint32_t)symbol << (31 - k);
+			if( reference_correlator_execute(&reference, symbol) ) {
+				expected_hits |= 0x80000000U >> k;
+				hit_count += 1;
+			}
+		}
+
+		const uint32_t hits = access_code_correlator_execute_word(&correlator, symbols, symbol_count);
+		if( hits != expected_hits ) {
+			return 0;
+		}
+		n += symbol_count;
+	}
+
+	return hit_count > 0;
+}
+
+/* A long 01 preamble matches the access code within the allowed distance
+ * every two symbols. Each packet must come out once, from the real start,
+ * in order, with its payload intact. Word sizes vary so payloads straddle
+ * every boundary.
+ */
+typedef struct pool_result_t {
+	const uint32_t* expected_start;
+	size_t count;
+	size_t expected_count;
+	bool in_order;
+	packet_digest_t digest;
+} pool_result_t;
+
+static void pool_result_handler(const void* const payload, const size_t payload_length, const uint32_t start_symbol, void* const context) {
+	pool_result_t* const result = (pool_result_t*)context;
+	if( (result->count >= result->expected_count) || (result->expected_start[result->count] != start_symbol) ) {
+		result->in_order = false;
+	}
+	result->count += 1;
+	packet_digest_add(&result->digest, (const uint8_t*)payload, payload_length, start_symbol);
+}
+
+typedef struct pool_feed_t {
+	packet_builder_pool_t* pool;
+	access_code_correlator_t* correlator;
+	uint32_t x;
+	uint32_t symbols;
+	size_t symbol_count;
+	size_t word_size;
+} pool_feed_t;
+
+static void pool_feed_symbol(pool_feed_t* const feed, const uint_fast8_t symbol) {
+	feed->symbols |= (uint32_t)symbol << (31 - feed->symbol_count);
+	feed->symbol_count += 1;
+	if( feed->symbol_count == feed->word_size ) {
+		const uint32_t hits = access_code_correlator_execute_word(feed->correlator, feed->symbols, feed->symbol_count);
+		packet_builder_pool_execute_word(feed->pool, feed->symbols, feed->symbol_count, hits, feed->correlator);
+		feed->symbols = 0;
+		feed->symbol_count = 0;
+		feed->word_size = 1 + (next_random(&feed->x) % 32);
+	}
+}
+
+static int test_pool_long_preamble(const uint32_t seed) {
+	const uint64_t code = 0x55555556;
+	const size_t code_length = 32;
+	const size_t payload_length = 160;
+
+	access_code_correlator_t correlator;
+	access_code_correlator_init(&correlator, code, code_length, 2);
+
+	uint32_t expected_start[16];
+	pool_result_t result = { expected_start, 0, 0, true, { 0, 0 } };
+	packet_digest_t expected_digest = { 0, 0 };
+	packet_builder_pool_t pool;
+	packet_builder_pool_init(&pool, payload_length, pool_result_handler, NULL, &result);
+
+	pool_feed_t feed = { &pool, &correlator, seed, 0, 0, 1 };
+	uint32_t x = seed;
+	uint32_t symbols_sent = 0;
+	for(size_t packet=0; packet<16; packet++) {
+		/* gap, preamble, access code, payload */
+		const size_t gap = 50 + (next_random(&x) % 100);
+		const size_t preamble = 2 * (next_random(&x) % 40);
+		const size_t payload_start = gap + preamble + code_length;
+		uint8_t payload[(160 + 7) / 8] = { 0 };
+		for(size_t n=0; n<payload_start + payload_length; n++) {
+			uint_fast8_t symbol;
+			if( n < gap ) {
+				symbol = next_random(&x) & 1;
+			} else if( n < gap + preamble ) {
+				symbol = (n - gap) & 1;
+			} else if( n < payload_start ) {
+				symbol = (code >> (payload_start - 1 - n)) & 1;
+			} else {
+				symbol = next_random(&x) & 1;
+				payload[(n - payload_start) >> 3] |= symbol << (7 - ((n - payload_start) & 7));
+			}
+			if( n == payload_start ) {
+				expected_start[result.expected_count++] = symbols_sent;
+			}
+
+			pool_feed_symbol(&feed, symbol);
+			symbols_sent += 1;
+		}
+		packet_digest_add(&expected_digest, payload, payload_length, expected_start[result.expected_count - 1]);
+	}
+
+	/* Candidates that start inside the last payload finish after it. */
+	for(size_t n=0; n<payload_length + 32; n++) {
+		pool_feed_symbol(&feed, 0);
+	}
+
+	return result.in_order &&
+		(result.count == result.expected_count) &&
+		(result.digest.hash == expected_digest.hash);
+}
+
+/* Random codes of 1 to 64 bits with random thresholds, all in one bank,
+ * against a popcount at every end position. Now and then one of the codes
+ * is dropped into the stream, a few of its bits flipped, so there are
+ * hits to compare.
+ */
+static int test_bank_matches_popcount(const uint32_t seed) {
+	uint32_t x = seed;
+
+	access_code_correlator_bank_t bank;
+	access_code_correlator_bank_init(&bank);
+	access_code_t codes[ACCESS_CODE_CORRELATOR_BANK_SIZE];
+	for(size_t i=0; i<ACCESS_CODE_CORRELATOR_BANK_SIZE; i++) {
+		const size_t code_length = 1 + (next_random(&x) % 64);
+		const uint64_t mask = (code_length < 64) ? ((1ULL << code_length) - 1) : ~0ULL;
+		const uint64_t code = (((uint64_t)next_random(&x) << 48) ^ ((uint64_t)next_random(&x) << 32) ^ ((uint64_t)next_random(&x) << 16) ^ next_random(&x)) & mask;
+		const size_t maximum_hamming_distance = (i == 0) ? 200 : (next_random(&x) % (code_length / 4 + 1));
+		codes[i].code = code;
+		codes[i].code_length = code_length;
+		codes[i].maximum_hamming_distance = (maximum_hamming_distance < ACCESS_CODE_DISTANCE_MAX) ? maximum_hamming_distance : ACCESS_CODE_DISTANCE_MAX;
+		if( access_code_correlator_bank_add(&bank, code, code_length, maximum_hamming_distance) != i ) {
+			return 0;
+		}
+	}
+	if( access_code_correlator_bank_add(&bank, 0, 8, 0) != ACCESS_CODE_CORRELATOR_BANK_SIZE ) {
+		return 0;
+	}
+
+	uint64_t history = 0;
+	const access_code_t* inserting = NULL;
+	size_t inserting_remaining = 0;
+	size_t hit_count = 0;
+	for(size_t n=0; n<16384; ) {
+		const size_t symbol_count = 1 + (next_random(&x) % 32);
+		uint32_t symbols = 0;
+		uint32_t expected_hits[ACCESS_CODE_CORRELATOR_BANK_SIZE] = { 0 };
+		uint32_t expected_found = 0;
+		size_t expected_best = ACCESS_CODE_DISTANCE_MAX + 1;
+		for(size_t k=0; k<symbol_count; k++) {
+			if( (inserting_remaining == 0) && ((next_random(&x) % 100) == 0) ) {
+				inserting = &codes[next_random(&x) % ACCESS_CODE_CORRELATOR_BANK_SIZE];
+				inserting_remaining = inserting->code_length;
+			}
+			uint_fast8_t symbol;
+			if( inserting_remaining > 0 ) {
+				inserting_remaining -= 1;
+				const uint_fast8_t flip = ((next_random(&x) % 30) == 0) ? 1 : 0;
+				symbol = ((inserting->code >> inserting_remaining) & 1) ^ flip;
+			} else {
+				symbol = next_random(&x) & 1;
+			}
+			symbols |= (uint32_t)symbol << (31 - k);
+			history = (history << 1) | symbol;
+
+			for(size_t i=0; i<ACCESS_CODE_CORRELATOR_BANK_SIZE; i++) {
+				const uint64_t mask = (codes[i].code_length < 64) ? ((1ULL << codes[i].code_length) - 1) : ~0ULL;
+				const size_t distance = __builtin_popcountll((history ^ codes[i].code) & mask);
+				if( distance <= codes[i].maximum_hamming_distance ) {
+					expected_hits[i] |= 0x80000000U >> k;
+					expected_found |= 1 << i;
+					expected_best = (distance < expected_best) ? distance : expected_best;
+				}
+			}
+		}
+
+		uint32_t hits[ACCESS_CODE_CORRELATOR_BANK_SIZE];
+		size_t best_distance = ACCESS_CODE_DISTANCE_MAX + 1;
+		const uint32_t found = access_code_correlator_bank_execute_word(&bank, symbols, symbol_count, hits, &best_distance);
+		if( found != expected_found ) {
+			return 0;
+		}
+		for(size_t i=0; i<ACCESS_CODE_CORRELATOR_BANK_SIZE; i++) {
+			if( hits[i] != expected_hits[i] ) {
+				return 0;
+			}
+		}
+		if( best_distance != expected_best ) {
+			return 0;
+		}
+		/* Code 0 always hits; count the others. */
+		hit_count += (found & ~1) ? 1 : 0;
+		n += symbol_count;
+	}
+
+	return hit_count > 0;
+}
+
+static int test_packet_builder() {
+	return
+		test_word_matches_reference(0x55555556, 32, 2, 1) &&		/* TPMS FSK */
+		test_word_matches_reference(0x1555557e, 30, 0, 2) &&		/* AIS-like, exact */
+		test_word_matches_reference(0x123456789abcdefULL, 60, 3, 3) &&
+		test_word_matches_reference(0xfedcba9876543210ULL, 64, 5, 4) &&
+		test_word_matches_reference(0xb, 4, 0, 5) &&
+		test_word_matches_reference(0xfedcba9876543210ULL, 64, 200, 6) &&	/* clamped, always hits */
+		test_bank_matches_popcount(7) &&
+		test_bank_matches_popcount(8) &&
+		test_bank_matches_popcount(9) &&
+		test_pool_long_preamble(7) &&
+		test_pool_long_preamble(8) &&
+		test_pool_long_preamble(9);
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void packet_builder_test() {
+	halt_if_failed(test_packet_builder());
+}
+
+#ifdef PACKET_BUILDER_TEST_HOST
+int main() {
+	return test_packet_builder() ? 0 : 1;
+}
+#endif
@@ -46,6 +46,7 @@
 #include "complex.h"
 #include "decimate.h"
 #include "demodulate.h"
+#include "nco.h"
 
 #include "rx_fm_broadcast.h"
 #include "rx_fm_narrowband.h"
@@ -54,6 +55,8 @@
 #include "rx_tpms_ask.h"
 #include "rx_tpms_fsk.h"
 #include "specan.h"
+#include "sweep.h"
+#include "zoom.h"
 
 #include "ipc.h"
 #include "ipc_m4.h"
@@ -80,7 +83,8 @@ void copy_to_audio_output(const int16_t* const source, const size_t sample_count
 	}
 }
 
-static void rx_tpms_ask_packet_handler(const void* const payload, const size_t payload_length, void* const context) {
+static void rx_tpms_ask_packet_handler(const void* const payload, const size_t payload_length, const uint32_t start_symbol, void* const context) {
+	(void)start_symbol;
 	(void)context;
 	ipc_command_packet_data_received(&device_state->ipc_m0, (uint8_t*)payload, payload_length);
 }
@@ -89,7 +93,8 @@ static void rx_tpms_ask_init_wrapper(void* const _state) {
 	rx_tpms_ask_init(_state, rx_tpms_ask_packet_handler);
 }
 
-static void rx_tpms_fsk_packet_handler(const void* const payload, const size_t payload_length, void* const context) {
+static void rx_tpms_fsk_packet_handler(const void* const payload, const size_t payload_length, const uint32_t start_symbol, void* const context) {
+	(void)start_symbol;
 	(void)context;
 	ipc_command_packet_data_received(&device_state->ipc_m0, (uint8_t*)payload, payload_length);
 }
@@ -98,7 +103,8 @@ static void rx_tpms_fsk_init_wrapper(void* const _state) {
 	rx_tpms_fsk_init(_state, rx_tpms_fsk_packet_handler);
 }
 
-static void rx_ais_packet_handler(const void* const payload, const size_t payload_length, void* const context) {
+static void rx_ais_packet_handler(const void* const payload, const size_t payload_length, const uint32_t start_symbol, void* const context) {
+	(void)start_symbol;
 	(void)context;
 	ipc_command_packet_data_received(&device_state->ipc_m0, (uint8_t*)payload, payload_length);
 }
@@ -109,16 +115,6 @@ static void rx_ais_init_wrapper(void* const _state) {
 
 static volatile receiver_baseband_handler_t receiver_baseband_handler = NULL;
 
-typedef enum {
-	RECEIVER_CONFIGURATION_SPEC = 0,
-	RECEIVER_CONFIGURATION_NBAM = 1,
-	RECEIVER_CONFIGURATION_NBFM = 2,
-	RECEIVER_CONFIGURATION_WBFM = 3,
-	RECEIVER_CONFIGURATION_TPMS = 4,
-	RECEIVER_CONFIGURATION_TPMS_FSK = 5,
-	RECEIVER_CONFIGURATION_AIS = 6,
-} receiver_configuration_id_t;
-
 typedef struct receiver_configuration_t {
 	receiver_state_init_t init;
 	receiver_baseband_handler_t baseband_handler;
@@ -126,6 +122,7 @@ typedef struct receiver_configuration_t {
 	uint32_t sample_rate;
 	uint32_t baseband_bandwidth;
 	uint32_t baseband_decimation;
+	uint32_t fine_tune_window;	/* Max. NCO offset (Hz) before retuning, 0 = no NCO stage */
 	bool enable_audio;
 } receiver_configuration_t;
 
@@ -137,6 +134,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 20000000,
 		.baseband_bandwidth = 10000000,
 		.baseband_decimation = 1,
+		.fine_tune_window = 0,
 		.enable_audio = false,
 	},
 	[RECEIVER_CONFIGURATION_NBAM] = {
@@ -146,6 +144,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 12288000,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 50000,	/* 768kHz + 50kHz stays clear of the 875kHz filter corner */
 		.enable_audio = true,
 	},
 	[RECEIVER_CONFIGURATION_NBFM] = {
@@ -155,6 +154,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 12288000,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 50000,
 		.enable_audio = true,
 	},
 	[RECEIVER_CONFIGURATION_WBFM] = {
@@ -164,6 +164,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 12288000,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 0,	/* The channel already fills the baseband filter */
 		.enable_audio = true,
 	},
 	[RECEIVER_CONFIGURATION_TPMS] = {
@@ -173,6 +174,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 12288000,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 50000,
 		.enable_audio = true,
 	},
 	[RECEIVER_CONFIGURATION_TPMS_FSK] = {
@@ -182,6 +184,7 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 9830400,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 100000,
 		.enable_audio = true,
 	},
 	[RECEIVER_CONFIGURATION_AIS] = {
@@ -191,6 +194,27 @@ const receiver_configuration_t receiver_configurations[] = {
 		.sample_rate = 9830400,
 		.baseband_bandwidth = 1750000,
 		.baseband_decimation = 4,
+		.fine_tune_window = 100000,
+		.enable_audio = false,
+	},
+	[RECEIVER_CONFIGURATION_SWEEP] = {
+		.init = sweep_init,
+		.baseband_handler = sweep_baseband_handler,
+		.tuning_offset = 0,
+		.sample_rate = 20000000,
+		.baseband_bandwidth = 15000000,
+		.baseband_decimation = 1,
+		.fine_tune_window = 0,
+		.enable_audio = false,
+	},
+	[RECEIVER_CONFIGURATION_ZOOM] = {
+		.init = zoom_init,
+		.baseband_handler = zoom_baseband_handler,
+		.tuning_offset = -5000000,
+		.sample_rate = 20000000,
+		.baseband_bandwidth = 20000000,
+		.baseband_decimation = 1,
+		.fine_tune_window = 0,
 		.enable_audio = false,
 	},
 };
@@ -211,11 +235,47 @@ complex_s8_t* wait_for_completed_baseband_buffer() {
 	return get_completed_baseband_buffer();
 }
 
+/* Frequency last given to the synthesizer. Tuning within the current
+ * configuration's fine_tune_window of it only changes the NCO.
+ */
+static int64_t synthesizer_frequency = 0;
+static bool synthesizer_frequency_valid = false;
+
+volatile uint32_t baseband_nco_phase_increment = 0;
+
+static uint32_t translated_sample_rate(const receiver_configuration_t* const receiver_configuration) {
+	return receiver_configuration->sample_rate / receiver_configuration->baseband_decimation / 2;
+}
+
 bool set_frequency(const int64_t new_frequency) {
 	const receiver_configuration_t* const receiver_configuration = get_receiver_configuration();
 
+	if( device_state->receiver_configuration_index == RECEIVER_CONFIGURATION_SWEEP ) {
+		/* The sweep owns the synthesizer and recentres on tuned_hz at the
+		 * start of every pass. Retuning here could also interrupt its SPI
+		 * traffic from the baseband ISR.
+		 */
+		device_state->tuned_hz = new_frequency;
+		return true;
+	}
+
 	const int64_t tuned_frequency = new_frequency + receiver_configuration->tuning_offset;
+
+	/* Small steps are a shift of the baseband: no synthesizer reprogramming,
+	 * no lock time, no lost blocks. The NCO moves the new frequency from
+	 * +fine_offset down to DC.
+	 */
+	const int64_t fine_offset = tuned_frequency - synthesizer_frequency;
+	if( synthesizer_frequency_valid && (fine_offset >= -(int64_t)receiver_configuration->fine_tune_window) && (fine_offset <= (int64_t)receiver_configuration->fine_tune_window) ) {
+		baseband_nco_phase_increment = nco_phase_increment(-fine_offset, translated_sample_rate(receiver_configuration));
+		device_state->tuned_hz = new_frequency;
+		return true;
+	}
+
 	if( set_freq(tuned_frequency) ) {
+		synthesizer_frequency = tuned_frequency;
+		synthesizer_frequency_valid = true;
+		baseband_nco_phase_increment = 0;
 		device_state->tuned_hz = new_frequency;
 		return true;
 	} else {
@@ -228,7 +288,7 @@ void increment_frequency(const int32_t increment) {
 	set_frequency(new_frequency);
 }
 
-static uint8_t receiver_state_buffer[4096];
+static uint8_t receiver_state_buffer[RECEIVER_STATE_BUFFER_SIZE] __attribute__((aligned(8)));
 
 void set_rx_mode(const size_t new_receiver_configuration_index) {
 	if( new_receiver_configuration_index >= ARRAY_SIZE(receiver_configurations) ) {
@@ -241,14 +301,18 @@ void set_rx_mode(const size_t new_receiver_configuration_index) {
 	sgpio_dma_stop();
 	sgpio_cpld_stream_disable();
 
-	/* TODO: Ensure receiver_state_buffer is large enough for new mode, or start using
-	 * heap to allocate necessary memory.
-	 */
+	/* Each receiver static_asserts that its state fits in receiver_state_buffer. */
 	const receiver_configuration_t* const old_receiver_configuration = get_receiver_configuration();
 	device_state->receiver_configuration_index = new_receiver_configuration_index;
 	const receiver_configuration_t* const receiver_configuration = get_receiver_configuration();
 
-	if( old_receiver_configuration->tuning_offset != receiver_configuration->tuning_offset ) {
+	/* The sweep tunes the synthesizer itself, and an NCO offset is only
+	 * valid at the old configuration's sample rate, so start over with a
+	 * full retune.
+	 */
+	const bool was_sweeping = (old_receiver_configuration == &receiver_configurations[RECEIVER_CONFIGURATION_SWEEP]);
+	if( was_sweeping || (baseband_nco_phase_increment != 0) || (old_receiver_configuration->tuning_offset != receiver_configuration->tuning_offset) ) {
+		synthesizer_frequency_valid = false;
 		set_frequency(device_state->tuned_hz);
 	}
 
@@ -268,12 +332,19 @@ void set_rx_mode(const size_t new_receiver_configuration_index) {
 }
 
 
-void handle_command_spectrum_data_done(const void* const arg) {
-	const ipc_command_spectrum_data_done_t* const command = (ipc_command_spectrum_data_done_t*)arg;
-	(void)command;
+void handle_command_set_sweep(const void* const arg) {
+	const ipc_command_set_sweep_t* const command = (ipc_command_set_sweep_t*)arg;
+
+	if( device_state->receiver_configuration_index == RECEIVER_CONFIGURATION_SWEEP ) {
+		sweep_configure(&receiver_state_buffer, command->width_hz, command->dwell_blocks, command->settle_blocks);
+	}
+}
+
+void handle_command_set_zoom(const void* const arg) {
+	const ipc_command_set_zoom_t* const command = (ipc_command_set_zoom_t*)arg;
 
-	if( device_state->receiver_configuration_index == RECEIVER_CONFIGURATION_SPEC ) {
-		specan_acknowledge_frame(&receiver_state_buffer);
+	if( device_state->receiver_configuration_index == RECEIVER_CONFIGURATION_ZOOM ) {
+		zoom_configure(&receiver_state_buffer, command->zoom_factor, command->center_offset_hz);
 	}
 }
 
@@ -298,6 +369,7 @@ void portapack_init() {
 
 	ipc_channel_init(&device_state->ipc_m4, ipc_m4_buffer);
 	ipc_channel_init(&device_state->ipc_m0, ipc_m0_buffer);
+	spectrum_frames_init(&device_state->spectrum_frames);
 
 	portapack_i2s_init();
 
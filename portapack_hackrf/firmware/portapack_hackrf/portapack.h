@@ -29,6 +29,7 @@
 
 #include "complex.h"
 #include "ipc.h"
+#include "spectrum_frames.h"
 
 //#define CPLD_PROGRAM 1
 //#define LCD_BACKLIGHT_TEST
@@ -36,6 +37,8 @@
 #define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
 #define M_PI (3.14159265358979323846264338327950f)
 
+#define RECEIVER_STATE_BUFFER_SIZE (4096)
+
 typedef struct baseband_timestamps_t {
 	uint32_t start;
 	uint32_t decimate_end;
@@ -47,6 +50,18 @@ typedef struct baseband_timestamps_t {
 typedef void (*receiver_state_init_t)(void* const state);
 typedef void (*receiver_baseband_handler_t)(void* const state, complex_s8_t* const data, const size_t sample_count, baseband_timestamps_t* const timestamps);
 
+typedef enum {
+	RECEIVER_CONFIGURATION_SPEC = 0,
+	RECEIVER_CONFIGURATION_NBAM = 1,
+	RECEIVER_CONFIGURATION_NBFM = 2,
+	RECEIVER_CONFIGURATION_WBFM = 3,
+	RECEIVER_CONFIGURATION_TPMS = 4,
+	RECEIVER_CONFIGURATION_TPMS_FSK = 5,
+	RECEIVER_CONFIGURATION_AIS = 6,
+	RECEIVER_CONFIGURATION_SWEEP = 7,
+	RECEIVER_CONFIGURATION_ZOOM = 8,
+} receiver_configuration_id_t;
+
 typedef struct dsp_metrics_t {
 	uint32_t duration_decimate;
 	uint32_t duration_channel_filter;
@@ -54,6 +69,7 @@ typedef struct dsp_metrics_t {
 	uint32_t duration_audio;
 	uint32_t duration_all;
 	uint32_t duration_all_millipercent;
+	uint32_t sweep_mhz_per_s;
 } dsp_metrics_t;
 
 typedef struct device_state_t {
@@ -69,12 +85,19 @@ typedef struct device_state_t {
 	ipc_channel_t ipc_m4;
 	ipc_channel_t ipc_m0;
 
+	spectrum_frames_t spectrum_frames;
+
 	dsp_metrics_t dsp_metrics;
 } device_state_t;
 
 void portapack_init();
 void portapack_run();
 
+/* Phase increment for the receivers' fine tuning NCO stage, which runs
+ * right after the -fs/4 translate. See set_frequency().
+ */
+extern volatile uint32_t baseband_nco_phase_increment;
+
 bool set_frequency(const int64_t new_frequency);
 void set_rx_mode(const size_t new_receiver_configuration_index);
 
@@ -38,6 +38,8 @@ uint8_t* const ipc_m0_buffer = (uint8_t*)0x20007800;
 const size_t ipc_m4_buffer_size = 1024;
 const size_t ipc_m0_buffer_size = 1024;
 
+static_assert(sizeof(device_state_t) <= 0x800, "device_state overlaps IPC buffers");
+
 #define PORTAPACK_SDIO_CD_SCU_PIN (P1_13)
 #define PORTAPACK_SDIO_CD_SCU_FUNCTION (SCU_CONF_FUNCTION7)
 #define PORTAPACK_SDIO_DAT0_SCU_PIN (P1_9)
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "resample.h"
+
+#include "arm_intrinsics.h"
+
+/* Interpolator taps, phase p (mu = p/32) for samples x[m-3]..x[m+4],
+ * output at x[m+mu]. Kaiser-windowed sinc, each phase normalized to
+ * 1 << 14 == 1.0. Phase 0 passes x[m] through, and phase 32 is phase 0
+ * advanced one sample, so adjacent phases can always be interpolated.
+ */
+static const int16_t resample_taps[33][8] = {
+	{      0,      0,      0,  16384,      0,      0,      0,      0 },
+	{    -26,    119,   -412,  16356,    448,   -128,     29,     -2 },
+	{    -50,    227,   -787,  16271,    932,   -266,     62,     -5 },
+	{    -69,    324,  -1124,  16127,   1449,   -412,     97,     -8 },
+	{    -86,    410,  -1423,  15927,   1998,   -564,    135,    -13 },
+	{   -100,    485,  -1684,  15670,   2577,   -723,    176,    -17 },
+	{   -111,    548,  -1908,  15364,   3182,   -886,    218,    -23 },
+	{   -119,    600,  -2094,  15003,   3812,  -1051,    262,    -29 },
+	{   -124,    641,  -2244,  14593,   4463,  -1218,    308,    -35 },
+	{   -127,    672,  -2360,  14141,   5131,  -1383,    353,    -43 },
+	{   -128,    692,  -2442,  13644,   5814,  -1545,    399,    -50 },
+	{   -127,    703,  -2492,  13110,   6507,  -1703,    445,    -59 },
+	{   -124,    705,  -2512,  12539,   7207,  -1853,    489,    -67 },
+	{   -120,    699,  -2505,  11939,   7909,  -1994,    531,    -75 },
+	{   -114,    685,  -2471,  11310,   8610,  -2122,    570,    -84 },
+	{   -108,    664,  -2414,  10660,   9305,  -2237,    606,    -92 },
+	{   -100,    638,  -2335,   9989,   9989,  -2335,    638,   -100 },
+	{    -92,    606,  -2237,   9305,  10660,  -2414,    664,   -108 },
+	{    -84,    570,  -2122,   8610,  11310,  -2471,    685,   -114 },
+	{    -75,    531,  -1994,   7909,  11939,  -2505,    699,   -120 },
+	{    -67,    489,  -1853,   7207,  12539,  -2512,    705,   -124 },
+	{    -59,    445,  -1703,   6507,  13110,  -2492,    703,   -127 },
+	{    -50,    399,  -1545,   5814,  13644,  -2442,    692,   -128 },
+	{    -43,    353,  -1383,   5131,  14141,  -2360,    672,   -127 },
+	{    -35,    308,  -1218,   4463,  14593,  -2244,    641,   -124 },
+	{    -29,    262,  -1051,   3812,  15003,  -2094,    600,   -119 },
+	{    -23,    218,   -886,   3182,  15364,  -1908,    548,   -111 },
+	{    -17,    176,   -723,   2577,  15670,  -1684,    485,   -100 },
+	{    -13,    135,   -564,   1998,  15927,  -1423,    410,    -86 },
+	{     -8,     97,   -412,   1449,  16127,  -1124,    324,    -69 },
+	{     -5,     62,   -266,    932,  16271,   -787,    227,    -50 },
+	{     -2,     29,   -128,    448,  16356,   -412,    119,    -26 },
+	{      0,      0,      0,      0,  16384,      0,      0,      0 },
+};
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+	while( b ) {
+		const uint32_t t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+void resample_real_s16_s16_init(
+	resample_real_s16_s16_state_t* const state,
+	const uint32_t input_rate,
+	const uint32_t output_rate
+) {
+	/* Each output advances input_rate / output_rate input samples:
+	 * step_int + step_frac / denominator, reduced so the fraction is exact.
+	 */
+	const uint32_t d = gcd(input_rate, output_rate);
+	const uint32_t numerator = input_rate / d;
+	state->denominator = output_rate / d;
+	state->step_int = numerator / state->denominator;
+	state->step_frac = numerator % state->denominator;
+	/* frac * reciprocal is the output position as a 0.32 fraction. */
+	state->reciprocal = (uint32_t)((1ULL << 32) / state->denominator);
+	state->frac = 0;
+	state->skip = 1;
+	state->z_index = 0;
+	for(size_t i=0; i<16; i++) {
+		state->z[i] = 0;
+	}
+}
+
+size_t resample_real_s16_s16(
+	resample_real_s16_s16_state_t* const state,
+	const int16_t* src,
+	int16_t* dst,
+	const size_t sample_count
+) {
+	const uint32_t step_int = state->step_int;
+	const uint32_t step_frac = state->step_frac;
+	const uint32_t denominator = state->denominator;
+	const uint32_t reciprocal = state->reciprocal;
+	uint32_t frac = state->frac;
+	uint32_t skip = state->skip;
+	int16_t* const z = &state->z[0];
+	size_t z_index = state->z_index;
+	int16_t* d = dst;
+
+	for(size_t n=sample_count; n>0; n--) {
+		z[z_index] = z[z_index + 8] = *(src++);
+		z_index = (z_index + 1) & 7;
+
+		if( --skip ) {
+			continue;
+		}
+
+		/* The window z[z_index..z_index+7] is x[m-3]..x[m+4]. Output
+		 * x[m+mu] for each mu in [0, 1) that falls here (more than one
+		 * when interpolating).
+		 */
+		const int16_t* const x = &z[z_index];
+		do {
+			const uint32_t mu = frac * reciprocal;		/* 0.32 */
+			const int16_t* const t0 = resample_taps[mu >> 27];
+			const int16_t* const t1 = t0 + 8;
+			const int32_t f = (mu >> 12) & 0x7fff;		/* Q15 between phases */
+
+			int32_t y0 = 0;
+			int32_t y1 = 0;
+			for(size_t j=0; j<8; j++) {
+				y0 += x[j] * t0[j];
+				y1 += x[j] * t1[j];
+			}
+			int32_t y = y0 + (int32_t)((((int64_t)y1 - y0) * f) >> 15);
+			*(d++) = __SSAT((y + (1 << 13)) >> 14, 16);
+
+			frac += step_frac;
+			skip = step_int;
+			if( frac >= denominator ) {
+				frac -= denominator;
+				skip += 1;
+			}
+		} while( skip == 0 );
+	}
+
+	state->frac = frac;
+	state->skip = skip;
+	state->z_index = z_index;
+
+	return d - dst;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __RESAMPLE_H__
+#define __RESAMPLE_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* Fractional (arbitrary ratio) resampler, int16 real samples.
+ *
+ * 8-tap polyphase interpolator with 32 phases, linearly interpolated
+ * between adjacent phases. The output position is tracked as an exact
+ * fraction of input_rate / output_rate, so the long-term output rate is
+ * exact (e.g. exactly 48kHz audio, or an exact multiple of a symbol rate).
+ *
+ * Interpolation error is around -60dB for signals below a quarter of the
+ * input rate. When the rate is reduced, the input must already be
+ * band-limited to below half the output rate (e.g. by the preceding
+ * decimation stages), so this is best used for the last, less-than-2x step.
+ */
+typedef struct resample_real_s16_s16_state_t {
+	uint32_t step_int;
+	uint32_t step_frac;
+	uint32_t denominator;
+	uint32_t reciprocal;
+	uint32_t frac;
+	uint32_t skip;
+	size_t z_index;
+	/* Circular delay line, each sample written twice (at z_index and
+	 * z_index + 8) so the 8-sample window is contiguous.
+	 */
+	int16_t z[16];
+} resample_real_s16_s16_state_t;
+
+void resample_real_s16_s16_init(
+	resample_real_s16_s16_state_t* const state,
+	const uint32_t input_rate,
+	const uint32_t output_rate
+);
+
+/* Returns the number of samples written to dst. When output_rate is lower
+ * than input_rate, this is never more than sample_count, and src and dst
+ * may be the same buffer. Otherwise dst must have room for
+ * sample_count * output_rate / input_rate + 1 samples.
+ */
+size_t resample_real_s16_s16(
+	resample_real_s16_s16_state_t* const state,
+	const int16_t* src,
+	int16_t* dst,
+	const size_t sample_count
+);
+
+#endif/*__RESAMPLE_H__*/
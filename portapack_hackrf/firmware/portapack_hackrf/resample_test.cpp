@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "resample_test.h"
+
+#include "resample.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define RESAMPLE_TEST_AMPLITUDE 16000.0
+
+/* -60dB of the amplitude. Measured worst case is about 12. */
+#define RESAMPLE_TEST_MAX_ERROR 16
+
+/* Uneven block sizes, so output positions carry across block boundaries. */
+static const size_t block_sizes[] = { 37, 128, 1, 500, 2, 2048, 7, 300 };
+
+static int16_t resample_test_input(const double frequency, const size_t n) {
+	return lrint(RESAMPLE_TEST_AMPLITUDE * sin(2.0 * M_PI * frequency * n + 0.3));
+}
+
+/* Feeds input_count samples of a sine at frequency (cycles per input
+ * sample) through the resampler. Output k must be the ideal interpolation
+ * at input position k * input_rate / output_rate - 4 (the filter delay),
+ * to within RESAMPLE_TEST_MAX_ERROR. Any drift from the exact rational
+ * rate shows up as a growing phase error; the output count must match it
+ * too.
+ */
+static int test_resample_real_s16_s16_rate(const uint32_t input_rate, const uint32_t output_rate, const double frequency) {
+	resample_real_s16_s16_state_t state;
+	resample_real_s16_s16_init(&state, input_rate, output_rate);
+
+	const size_t input_count = 40000;
+	size_t input_index = 0;
+	size_t output_index = 0;
+	size_t block_index = 0;
+	int16_t src[2048];
+	int16_t dst[2048 * 4 + 1];
+
+	while( input_index < input_count ) {
+		const size_t block_size = block_sizes[block_index++ % (sizeof(block_sizes) / sizeof(block_sizes[0]))];
+		const size_t n = (block_size < (input_count - input_index)) ? block_size : (input_count - input_index);
+		for(size_t i=0; i<n; i++) {
+			src[i] = resample_test_input(frequency, input_index + i);
+		}
+		input_index += n;
+
+		const size_t out_count = resample_real_s16_s16(&state, src, dst, n);
+		for(size_t k=0; k<out_count; k++, output_index++) {
+			/* Exact position: the product is an integer in 64 bits. */
+			const uint64_t position_num = (uint64_t)output_index * input_rate;
+
+			/* Skip outputs that still see the zeroed delay line. */
+			if( position_num < ((uint64_t)8 * output_rate) ) {
+				continue;
+			}
+
+			const double position = (double)(position_num / output_rate) + (double)(position_num % output_rate) / output_rate - 4.0;
+			const double expected = RESAMPLE_TEST_AMPLITUDE * sin(2.0 * M_PI * frequency * position + 0.3);
+			const int32_t error = dst[k] - lrint(expected);
+			if( (error > RESAMPLE_TEST_MAX_ERROR) || (error < -RESAMPLE_TEST_MAX_ERROR) ) {
+				return 0;
+			}
+		}
+	}
+
+	/* Output k is produced by input sample floor(k * input_rate / output_rate),
+	 * so input_count samples give ceil(input_count * output_rate / input_rate).
+	 */
+	const uint64_t expected_count = ((uint64_t)input_count * output_rate + input_rate - 1) / input_rate;
+	return output_index == expected_count;
+}
+
+static int test_resample_real_s16_s16_in_place() {
+	/* Reducing the rate may run in place; the result must not change. */
+	resample_real_s16_s16_state_t state_a;
+	resample_real_s16_s16_state_t state_b;
+	resample_real_s16_s16_init(&state_a, 48000, 44100);
+	resample_real_s16_s16_init(&state_b, 48000, 44100);
+
+	int16_t data[512];
+	int16_t src[512];
+	int16_t dst[512];
+	for(size_t i=0; i<512; i++) {
+		data[i] = src[i] = resample_test_input(0.05, i);
+	}
+
+	const size_t count_a = resample_real_s16_s16(&state_a, data, data, 512);
+	const size_t count_b = resample_real_s16_s16(&state_b, src, dst, 512);
+	if( count_a != count_b ) {
+		return 0;
+	}
+	for(size_t i=0; i<count_a; i++) {
+		if( data[i] != dst[i] ) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static int test_resample_real_s16_s16() {
+	return
+		/* Reducing: 48kHz to 44.1kHz, and by an odd ratio near 4:3. */
+		test_resample_real_s16_s16_rate(48000, 44100, 0.05) &&
+		test_resample_real_s16_s16_rate(48000, 44100, 0.2) &&
+		test_resample_real_s16_s16_rate(76800, 19200 * 3 + 1, 0.1) &&
+		/* Increasing: 31.25kHz to 48kHz, and by an awkward prime ratio. */
+		test_resample_real_s16_s16_rate(31250, 48000, 0.05) &&
+		test_resample_real_s16_s16_rate(7001, 16127, 0.25) &&
+		test_resample_real_s16_s16_in_place();
+}
+
+static void halt_if_failed(const int test_result) {
+	if( !test_result ) {
+		while(1);
+	}
+}
+
+void resample_test() {
+	halt_if_failed(test_resample_real_s16_s16());
+}
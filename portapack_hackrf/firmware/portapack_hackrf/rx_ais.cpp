@@ -23,35 +23,46 @@
 
 #include "filters.h"
 #include "decimate.h"
+#include "decimation_chain.h"
 #include "demodulate.h"
 #include "clock_recovery.h"
-#include "access_code_correlator.h"
-#include "packet_builder.h"
+#include "hdlc.h"
 
 #include <cassert>
 
+typedef decimation_chain<
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage,
+	nco_cplx_s16_s16_stage<&baseband_nco_phase_increment>,
+	fir_cic3_decim_2_s16_s16_stage<1>,
+	fir_cic3_decim_2_s16_s16_stage<3>,
+	fir_cic3_decim_2_s16_s16_stage<0>
+> rx_ais_bb_dec_t;
+
+static_assert(rx_ais_bb_dec_t::output_rate(2457600) == 153600, "baseband decimation rate");
+
 typedef struct rx_ais_state_t {
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t bb_dec_1;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_2;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_3;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_4;
+	rx_ais_bb_dec_t::state_t bb_dec;
 	fir_64_decim_8_cplx_s16_s16_state_t channel_dec;
 	fm_demodulate_s16_s16_state_t fm_demodulate;
 	clock_recovery_t clock_recovery;
-	access_code_correlator_t access_code_correlator;
-	packet_builder_t packet_builder;
-	uint_fast8_t last_symbol;
+	hdlc_decoder_t hdlc;
+	uint32_t last_symbol;
 } rx_ais_state_t;
 
-static void rx_ais_clock_recovery_symbol_handler(const float value, void* const context) {
-	rx_ais_state_t* const state = (rx_ais_state_t*)context;
+static_assert(sizeof(rx_ais_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
 
-	const uint_fast8_t symbol = (value >= 0.0f) ? 1 : 0;
-	const uint_fast8_t nrzi_bit = (~(symbol ^ state->last_symbol)) & 1;
-	state->last_symbol = symbol;
-	const bool access_code_found = access_code_correlator_execute(&state->access_code_correlator, nrzi_bit);
-	packet_builder_execute(&state->packet_builder, nrzi_bit, access_code_found);
-}
+struct rx_ais_symbol_sink {
+	rx_ais_state_t* const state;
+
+	void operator()(const int16_t* const symbols, const size_t count) {
+		const uint32_t packed = clock_recovery_pack_symbols(symbols, count);
+		/* NRZI: 1 where a symbol equals the one before it. */
+		const uint32_t previous = (packed >> 1) | (state->last_symbol << 31);
+		const uint32_t nrzi_bits = ~(packed ^ previous);
+		state->last_symbol = (packed >> (32 - count)) & 1;
+		hdlc_decoder_execute_word(&state->hdlc, nrzi_bits, count);
+	}
+};
 
 void rx_ais_init(void* const _state, packet_builder_payload_handler_t payload_handler) {
 	rx_ais_state_t* const state = (rx_ais_state_t*)_state;
@@ -59,15 +70,12 @@ void rx_ais_init(void* const _state, packet_builder_payload_handler_t payload_ha
 	const float symbol_rate = 9600.0f;
 	const float sample_rate = 19200.0f;
 
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state->bb_dec_1);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_2);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_3);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_4);
+	rx_ais_bb_dec_t::init(state->bb_dec);
 	fir_64_decim_8_cplx_s16_s16_init(&state->channel_dec, taps_64_lp_031_063, 64);
 	fm_demodulate_s16_s16_init(&state->fm_demodulate, sample_rate, symbol_rate / 4);
-	clock_recovery_init(&state->clock_recovery, symbol_rate / sample_rate, rx_ais_clock_recovery_symbol_handler, state);
-	access_code_correlator_init(&state->access_code_correlator, 0b010101010101010101010101111110, 30, 0);
-	packet_builder_init(&state->packet_builder, 256, payload_handler, state);
+	clock_recovery_init(&state->clock_recovery, symbol_rate / sample_rate, 8);
+	hdlc_decoder_init(&state->hdlc, payload_handler, state);
+	state->last_symbol = 0;
 }
 
 void rx_ais_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps) {
@@ -78,49 +86,18 @@ void rx_ais_baseband_handler(void* const _state, complex_s8_t* const in, const s
 	/* 2.4576MHz complex<int8>[N]
 	 * -> Shift by -fs/4
 	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 1.2288MHz complex<int16>[N/2] */
-	/* i,q: +/-128 */
-	sample_count = translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state->bb_dec_1, in, sample_count);
-	complex_s16_t* const in_cs16 = (complex_s16_t*)in;
-
-	/* 1.2288MHz complex<int16>[N/2]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 614.4kHz complex<int16>[N/4] */
-	/* i,q: +/-1024 */
+	 * -> 1.2288MHz
+	 * -> NCO fine tuning shift (see set_frequency)
+	 * -> 3rd order CIC decimation by 2, gain of 4 (rounded, saturated)
+	 * -> 614.4kHz
+	 * -> 3rd order CIC decimation by 2, gain of 1 (rounded, saturated)
+	 * -> 307.2kHz
+	 * -> 3rd order CIC decimation by 2, gain of 8 (saturated)
+	 * -> 153.6kHz complex<int16>[N/16] */
 	complex_s16_t work[512];
 	complex_s16_t* const work_cs16 = work;
 	int16_t* const work_int16 = (int16_t*)work;
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_2, in_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	/* i,q: +/-8192 */
-	complex_s16_t* p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 2;
-		p->q /= 2;
-		p++;
-	}
-
-	/* 614.4kHz complex<int16>[N/4]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 307.2kHz complex<int16>[N/8] */
-	/* i,q: +/-4096 */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_3, work_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	/* i,q: +/-32768 */
-	p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 8;
-		p->q /= 8;
-		p++;
-	}
-
-	/* 307.2kHz complex<int16>[N/8]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 153.6kHz complex<int16>[N/16] */
-	/* i,q: +/-4096 */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_4, work_cs16, work_cs16, sample_count);
+	sample_count = rx_ais_bb_dec_t::execute(state->bb_dec, in, work_cs16, sample_count);
 
 	timestamps->decimate_end = baseband_timestamp();
 
@@ -138,7 +115,9 @@ void rx_ais_baseband_handler(void* const _state, complex_s8_t* const in, const s
 
 	timestamps->demodulate_end = baseband_timestamp();
 
-	for(size_t n=0; n<sample_count; n++) {
-		clock_recovery_execute(&state->clock_recovery, work_int16[n]);		
-	}
+	/* 19.2kHz int16[N/128], two samples per symbol
+	 * -> Gardner clock recovery
+	 * -> 9.6kHz symbols */
+	rx_ais_symbol_sink sink = { state };
+	clock_recovery_process<clock_recovery_gardner>(&state->clock_recovery, work_int16, sample_count, sink);
 }
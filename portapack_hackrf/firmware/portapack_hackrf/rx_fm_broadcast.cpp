@@ -24,12 +24,20 @@
 #include "portapack.h"
 
 #include "decimate.h"
+#include "decimation_chain.h"
 #include "demodulate.h"
 #include "filters.h"
 
+typedef decimation_chain<
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage,
+	fir_cic3_decim_2_s16_s16_stage<0>
+> rx_fm_broadcast_to_audio_bb_dec_t;
+
+static_assert(rx_fm_broadcast_to_audio_bb_dec_t::output_rate(3072000) == 768000, "baseband decimation rate");
+
 typedef struct rx_fm_broadcast_to_audio_state_t {
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t dec_stage_1_state;
-	fir_cic3_decim_2_s16_s16_state_t dec_stage_2_state;
+	rx_fm_broadcast_to_audio_bb_dec_t::state_t bb_dec;
+	fir_sym_cplx_s16_s16_state_t channel_filter;
 	fm_demodulate_s16_s16_state_t fm_demodulate_state;
 	fir_cic4_decim_2_real_s16_s16_state_t audio_dec_1;
 	fir_cic4_decim_2_real_s16_s16_state_t audio_dec_2;
@@ -37,11 +45,13 @@ typedef struct rx_fm_broadcast_to_audio_state_t {
 	fir_64_decim_2_real_s16_s16_state_t audio_dec_4;
 } rx_fm_broadcast_to_audio_state_t;
 
+static_assert(sizeof(rx_fm_broadcast_to_audio_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+
 void rx_fm_broadcast_to_audio_init(void* const _state) {
 	rx_fm_broadcast_to_audio_state_t* const state = (rx_fm_broadcast_to_audio_state_t*)_state;
 
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state->dec_stage_1_state);
-	fir_cic3_decim_2_s16_s16_init(&state->dec_stage_2_state);
+	rx_fm_broadcast_to_audio_bb_dec_t::init(state->bb_dec);
+	fir_sym_cplx_s16_s16_init(&state->channel_filter, taps_25_lp_130_260, 25);
 	fm_demodulate_s16_s16_init(&state->fm_demodulate_state, 768000, 75000);
 	fir_cic4_decim_2_real_s16_s16_init(&state->audio_dec_1);
 	fir_cic4_decim_2_real_s16_s16_init(&state->audio_dec_2);
@@ -57,26 +67,20 @@ void rx_fm_broadcast_to_audio_baseband_handler(void* const _state, complex_s8_t*
 	/* 3.072MHz complex<int8>[N]
 	 * -> Shift by -fs/4
 	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 1.544MHz complex<int16>[N/2] */
-	sample_count = translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state->dec_stage_1_state, in, sample_count);
-	complex_s16_t* const in_cs16 = (complex_s16_t*)in;
-
-	/* 1.544MHz complex<int16>[N/2]
-	 * -> 3rd order CIC decimation by 2, gain of 8
+	 * -> 1.544MHz
+	 * -> 3rd order CIC decimation by 2, gain of 8 (saturated)
 	 * -> 768kHz complex<int16>[N/4] */
 	complex_s16_t work[512];
 	complex_s16_t* const work_cs16 = work;
 	int16_t* const work_int16 = (int16_t*)work;
-	sample_count = fir_cic3_decim_2_s16_s16(&state->dec_stage_2_state, in_cs16, work_cs16, sample_count);
+	sample_count = rx_fm_broadcast_to_audio_bb_dec_t::execute(state->bb_dec, in, work_cs16, sample_count);
 
 	timestamps->decimate_end = baseband_timestamp();
 
-	/* 768kHz complex<int32>[N/4]
-	 * -> FIR LPF, 90kHz cut-off, max attenuation by 192kHz.
-	 * -> 768kHz complex<int32>[N/4] */
-	/* TODO: To improve adjacent channel rejection, implement complex channel filter:
-	 *		pass < +/- 100kHz, stop > +/- 200kHz
-	 */
+	/* 768kHz complex<int16>[N/4]
+	 * -> 25-tap symmetric FIR, <100kHz (0.130fs) pass, >200kHz (0.260fs) stop, gain of 1
+	 * -> 768kHz complex<int16>[N/4] */
+	sample_count = fir_sym_cplx_s16_s16(&state->channel_filter, work_cs16, work_cs16, sample_count);
 
 	timestamps->channel_filter_end = baseband_timestamp();
 
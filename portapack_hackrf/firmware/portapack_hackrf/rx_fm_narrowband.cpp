@@ -22,28 +22,34 @@
 #include "rx_fm_narrowband.h"
 
 #include "decimate.h"
+#include "decimation_chain.h"
 #include "demodulate.h"
 #include "filters.h"
 
+typedef decimation_chain<
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage,
+	nco_cplx_s16_s16_stage<&baseband_nco_phase_increment>,
+	fir_cic3_decim_2_s16_s16_stage<1>,
+	fir_cic3_decim_2_s16_s16_stage<3>,
+	fir_cic3_decim_2_s16_s16_stage<3>,
+	fir_cic3_decim_2_s16_s16_stage<0>
+> rx_fm_narrowband_to_audio_bb_dec_t;
+
+static_assert(rx_fm_narrowband_to_audio_bb_dec_t::output_rate(3072000) == 96000, "baseband decimation rate");
+
 typedef struct rx_fm_narrowband_to_audio_state_t {
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t bb_dec_1;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_2;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_3;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_4;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_5;
+	rx_fm_narrowband_to_audio_bb_dec_t::state_t bb_dec;
 	// TODO: Channel filter here.
 	fm_demodulate_s16_s16_state_t fm_demodulate;
 	fir_64_decim_2_real_s16_s16_state_t audio_dec;
 } rx_fm_narrowband_to_audio_state_t;
 
+static_assert(sizeof(rx_fm_narrowband_to_audio_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+
 void rx_fm_narrowband_to_audio_init(void* const _state) {
 	rx_fm_narrowband_to_audio_state_t* const state = (rx_fm_narrowband_to_audio_state_t*)_state;
 
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state->bb_dec_1);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_2);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_3);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_4);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_5);
+	rx_fm_narrowband_to_audio_bb_dec_t::init(state->bb_dec);
 	// TODO: Channel filter here.
 	fm_demodulate_s16_s16_init(&state->fm_demodulate, 96000, 2500);
 	fir_64_decim_2_real_s16_s16_init(&state->audio_dec, taps_64_lp_031_063, 64);
@@ -57,64 +63,20 @@ void rx_fm_narrowband_to_audio_baseband_handler(void* const _state, complex_s8_t
 	/* 3.072MHz complex<int8>[N]
 	 * -> Shift by -fs/4
 	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 1.544MHz complex<int16>[N/2] */
-	sample_count = translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state->bb_dec_1, in, sample_count);
-	complex_s16_t* const in_cs16 = (complex_s16_t*)in;
-
-	/* 1.544MHz complex<int16>[N/2]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 768kHz complex<int16>[N/4] */
+	 * -> 1.544MHz
+	 * -> NCO fine tuning shift (see set_frequency)
+	 * -> 3rd order CIC decimation by 2, gain of 4 (rounded, saturated)
+	 * -> 768kHz
+	 * -> 3rd order CIC decimation by 2, gain of 1 (rounded, saturated)
+	 * -> 384kHz
+	 * -> 3rd order CIC decimation by 2, gain of 1 (rounded, saturated)
+	 * -> 192kHz
+	 * -> 3rd order CIC decimation by 2, gain of 8 (saturated)
+	 * -> 96kHz complex<int16>[N/32] */
 	complex_s16_t work[512];
 	complex_s16_t* const work_cs16 = work;
 	int16_t* const work_int16 = (int16_t*)work;
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_2, in_cs16, work_cs16, sample_count);
-
-	/* TODO: Gain through five CICs will be 32768 (8 ^ 5). Incorporate gain adjustment
-	 * somewhere in the chain.
-	 */
-
-	/* TODO: Create a decimate_by_2_s16_s16 with gain adjustment and rounding, maybe use
-	 * SSAT (no rounding) or use SMMULR/SMMLAR/SMMLSR (provides rounding)?
-	 */
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	complex_s16_t* p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 2;
-		p->q /= 2;
-		p++;
-	}
-
-	/* 768kHz complex<int16>[N/4]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 384kHz complex<int16>[N/8] */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_3, work_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 8;
-		p->q /= 8;
-		p++;
-	}
-
-	/* 384kHz complex<int16>[N/8]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 192kHz complex<int16>[N/16] */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_4, work_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 8;
-		p->q /= 8;
-		p++;
-	}
-
-	/* 192kHz complex<int16>[N/16]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 96kHz complex<int16>[N/32] */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_5, work_cs16, work_cs16, sample_count);
+	sample_count = rx_fm_narrowband_to_audio_bb_dec_t::execute(state->bb_dec, in, work_cs16, sample_count);
 
 	timestamps->decimate_end = baseband_timestamp();
 
@@ -24,31 +24,60 @@
 #include "i2s.h"
 
 #include "decimate.h"
+#include "decimation_chain.h"
 #include "demodulate.h"
-#include "envelope.h"
 #include "clock_recovery.h"
 #include "access_code_correlator.h"
 #include "packet_builder.h"
+#include "manchester.h"
 
-#include <math.h>
+#include "arm_intrinsics.h"
+
+typedef decimation_chain<
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_stage,
+	nco_cplx_s16_s16_stage<&baseband_nco_phase_increment>,
+	fir_cic3_decim_2_s16_s16_stage<1>,
+	fir_cic3_decim_2_s16_s16_stage<3>,
+	fir_cic3_decim_2_s16_s16_stage<0>
+> rx_tpms_ask_bb_dec_t;
+
+static_assert(rx_tpms_ask_bb_dec_t::output_rate(3072000) == 192000, "baseband decimation rate");
 
 typedef struct rx_tpms_ask_state_t {
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t bb_dec_1;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_2;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_3;
-	fir_cic3_decim_2_s16_s16_state_t bb_dec_4;
-	envelope_t envelope;
+	rx_tpms_ask_bb_dec_t::state_t bb_dec;
+	am_envelope_normalize_u16_s16_state_t envelope;
 	clock_recovery_t clock_recovery;
 	access_code_correlator_t access_code_correlator;
-	packet_builder_t packet_builder;
+	packet_builder_pool_t packet_builders;
 } rx_tpms_ask_state_t;
 
-static void rx_tpms_ask_clock_recovery_symbol_handler(const float value, void* const context) {
-	rx_tpms_ask_state_t* const state = (rx_tpms_ask_state_t*)context;
+static_assert(sizeof(rx_tpms_ask_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+
+struct rx_tpms_ask_symbol_sink {
+	rx_tpms_ask_state_t* const state;
+
+	void operator()(const int16_t* const symbols, const size_t count) {
+		const uint32_t packed = clock_recovery_pack_symbols(symbols, count);
+		const uint32_t hits = access_code_correlator_execute_word(&state->access_code_correlator, packed, count);
+		packet_builder_pool_execute_word(&state->packet_builders, packed, count, hits, &state->access_code_correlator);
+	}
+};
 
-	const uint_fast8_t symbol = (value >= 0.0f) ? 1 : 0;
-	const bool access_code_found = access_code_correlator_execute(&state->access_code_correlator, symbol);
-	packet_builder_execute(&state->packet_builder, symbol, access_code_found);
+/* Payload is Manchester coded, 37 data bits. More than one error in
+ * eight bits is noise, or a candidate off by one symbol.
+ */
+static int32_t rx_tpms_ask_payload_score(const void* const payload, const size_t payload_length, void* const context) {
+	(void)context;
+	const size_t data_bits = payload_length / 2;
+	uint8_t value[5];
+	uint8_t errors[5];
+	manchester_decode((const uint8_t*)payload, value, errors, data_bits, MANCHESTER_IEEE_802_3);
+
+	size_t error_count = 0;
+	for(size_t i=0; i<ARRAY_SIZE(errors); i++) {
+		error_count += __builtin_popcount(errors[i]);
+	}
+	return (error_count > (data_bits / 8)) ? -1 : (int32_t)error_count;
 }
 
 void rx_tpms_ask_init(void* const _state, packet_builder_payload_handler_t payload_handler) {
@@ -57,14 +86,14 @@ void rx_tpms_ask_init(void* const _state, packet_builder_payload_handler_t paylo
 	const float symbol_rate = 8192.0f;
 	const float sample_rate = 192000.0f;
 
-	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state->bb_dec_1);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_2);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_3);
-	fir_cic3_decim_2_s16_s16_init(&state->bb_dec_4);
-	envelope_init(&state->envelope, 0.08f, 0.01f);
-	clock_recovery_init(&state->clock_recovery, symbol_rate / sample_rate, rx_tpms_ask_clock_recovery_symbol_handler, state);
+	rx_tpms_ask_bb_dec_t::init(state->bb_dec);
+	am_envelope_normalize_u16_s16_init(&state->envelope, 0.08f, 0.01f);
+	/* A gain shift of 6 tracks +/-0.5% symbol rate error on the square
+	 * envelope; 8 slips at 0.3%. See clock_recovery_test.
+	 */
+	clock_recovery_init(&state->clock_recovery, symbol_rate / sample_rate, 6);
 	access_code_correlator_init(&state->access_code_correlator, 0b01010101010101010101010101011110, 32, 2);
-	packet_builder_init(&state->packet_builder, 74, payload_handler, state);
+	packet_builder_pool_init(&state->packet_builders, 74, payload_handler, rx_tpms_ask_payload_score, state);
 }
 
 void rx_tpms_ask_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps) {
@@ -75,48 +104,17 @@ void rx_tpms_ask_baseband_handler(void* const _state, complex_s8_t* const in, co
 	/* 3.072MHz complex<int8>[N]
 	 * -> Shift by -fs/4
 	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 1.544MHz complex<int16>[N/2] */
-	/* i,q: +/-128 */
-	sample_count = translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state->bb_dec_1, in, sample_count);
-	complex_s16_t* const in_cs16 = (complex_s16_t*)in;
-
-	/* 1.544MHz complex<int16>[N/2]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 768kHz complex<int16>[N/4] */
-	/* i,q: +/-1024 */
+	 * -> 1.544MHz
+	 * -> NCO fine tuning shift (see set_frequency)
+	 * -> 3rd order CIC decimation by 2, gain of 4 (rounded, saturated)
+	 * -> 768kHz
+	 * -> 3rd order CIC decimation by 2, gain of 1 (rounded, saturated)
+	 * -> 384kHz
+	 * -> 3rd order CIC decimation by 2, gain of 8 (saturated)
+	 * -> 192kHz complex<int16>[N/16] */
 	complex_s16_t work[512];
 	complex_s16_t* const work_cs16 = work;
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_2, in_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	/* i,q: +/-8192 */
-	complex_s16_t* p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 2;
-		p->q /= 2;
-		p++;
-	}
-
-	/* 768kHz complex<int16>[N/4]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 384kHz complex<int16>[N/8] */
-	/* i,q: +/-4096 */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_3, work_cs16, work_cs16, sample_count);
-
-	/* Temporary code to adjust gain in complex_s16_t samples out of CIC stages */
-	/* i,q: +/-32768 */
-	p = work_cs16;
-	for(uint_fast16_t n=sample_count; n>0; n-=1) {
-		p->i /= 8;
-		p->q /= 8;
-		p++;
-	}
-
-	/* 384kHz complex<int16>[N/8]
-	 * -> 3rd order CIC decimation by 2, gain of 8
-	 * -> 192kHz complex<int16>[N/16] */
-	/* i,q: +/-4096 */
-	sample_count = fir_cic3_decim_2_s16_s16(&state->bb_dec_4, work_cs16, work_cs16, sample_count);
+	sample_count = rx_tpms_ask_bb_dec_t::execute(state->bb_dec, in, work_cs16, sample_count);
 
 	timestamps->decimate_end = baseband_timestamp();
 
@@ -130,19 +128,26 @@ void rx_tpms_ask_baseband_handler(void* const _state, complex_s8_t* const in, co
 	 * -> AM demodulation
 	 * -> 192kHz int16[N/16] */
 	/* i,q: +/-23552 */
-	float* const out_mag = (float*)work;
-	am_demodulate_s16_f32(work_cs16, out_mag, sample_count);
+	uint16_t out_mag[ARRAY_SIZE(work)];
+	am_demodulate_s16_s16(work_cs16, out_mag, sample_count, AM_MAGNITUDE_BETTER);
 	/* +33308 */
 
-	for(uint_fast16_t i=0; i<sample_count; i++) {
-		const float env_out = envelope_execute(&state->envelope, out_mag[i]);
-		clock_recovery_execute(&state->clock_recovery, env_out);
-	}
+	/* Envelope-normalized magnitude, -1.0 to ~+3.0 in Q13, saturated. */
+	int16_t env_out[ARRAY_SIZE(work)];
+	am_envelope_normalize_u16_s16(&state->envelope, out_mag, env_out, sample_count);
+
+	/* 192kHz int16[N/16], ~23.4 samples per symbol
+	 * -> Gardner clock recovery. The envelope is flat between edges, which
+	 *    gives Mueller-Muller no timing error to work with; Gardner's
+	 *    midpoint sample sits on the edge.
+	 * -> 8.192kHz symbols */
+	rx_tpms_ask_symbol_sink sink = { state };
+	clock_recovery_process<clock_recovery_gardner>(&state->clock_recovery, env_out, sample_count, sink);
 
 	timestamps->demodulate_end = baseband_timestamp();
 
 	int16_t* const audio_tx_buffer = portapack_i2s_tx_empty_buffer();
 	for(size_t i=0, j=0; i<I2S_BUFFER_SAMPLE_COUNT; i++, j++) {
-		audio_tx_buffer[i*2] = audio_tx_buffer[i*2+1] = (int16_t)out_mag[j*4];
+		audio_tx_buffer[i*2] = audio_tx_buffer[i*2+1] = __SSAT(out_mag[j*4], 16);
 	}
 }
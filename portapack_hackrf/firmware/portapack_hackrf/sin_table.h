@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __SIN_TABLE_H__
+#define __SIN_TABLE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "index_list.h"
+
+/* Compile-time sine tables. Values come from a Taylor series evaluated by
+ * the compiler, so there is no sinf() at run time and the tables land in
+ * flash.
+ *
+ *	template<size_t... I>
+ *	struct my_table<index_list<I...>> {
+ *		static constexpr int16_t values[sizeof...(I)] = { sin_q15(sin_turn(I, 1024))... };
+ *	};
+ *	typedef my_table<make_index_list<1024>::type> my_table_1024;
+ */
+
+static constexpr double sin_table_pi = 3.14159265358979323846;
+
+/* Plenty of terms for |x| <= pi/2. */
+static constexpr double sin_table_series(const double x2, const double term, const int k) {
+	return (k > 29) ? 0.0 : term + sin_table_series(x2, -term * x2 / ((k + 1) * (k + 2)), k + 2);
+}
+
+static constexpr double sin_table_series_x(const double x) {
+	return sin_table_series(x * x, x, 1);
+}
+
+/* sin(pi/2 * i / quarter), for i = 0..quarter */
+static constexpr double sin_quarter(const size_t i, const size_t quarter) {
+	return sin_table_series_x(sin_table_pi * i / (2 * quarter));
+}
+
+/* sin(2 * pi * i / n), for any i. n must be a multiple of 4. */
+static constexpr double sin_turn(const size_t i, const size_t n) {
+	return
+		((i % n) < (n / 4)) ? sin_quarter(i % n, n / 4) :
+		((i % n) < (n / 2)) ? sin_quarter(n / 2 - (i % n), n / 4) :
+		((i % n) < (3 * n / 4)) ? -sin_quarter((i % n) - n / 2, n / 4) :
+		-sin_quarter(n - (i % n), n / 4);
+}
+
+/* Round to Q15, saturating +1.0 to 32767. */
+static constexpr int16_t sin_q15(const double x) {
+	return (x * 32768.0 + 0.5 >= 32767.0) ? 32767 :
+		(x >= 0.0) ? (int16_t)(x * 32768.0 + 0.5) : (int16_t)-(int32_t)(-x * 32768.0 + 0.5);
+}
+
+#endif/*__SIN_TABLE_H__*/
@@ -26,75 +26,126 @@
 #include "complex.h"
 #include "window.h"
 #include "fft.h"
-
-#include <math.h>
+#include "log_power.h"
+#include "iq_correct.h"
 
 #include "portapack_driver.h"
 #include "ipc_m0_client.h"
 
+#include <string.h>
+
 #include <algorithm>
 
 typedef struct specan_state_t {
-	float avg[256];
-	float peak[256];
-	uint8_t avg_log[256];
-	uint8_t peak_log[256];
+	uint64_t avg[256];
+	uint32_t peak[256];
 	size_t sample_frames;
 	size_t frame_count;
+	size_t fft_hop;
+	size_t ffts_per_block_max;
+	size_t ffts_per_block;
+	size_t ffts_accumulated;
 	float mag_2_scale;
 	float spectrum_floor;
 	float spectrum_gain;
+	log_power_state_t peak_log_power;
+	iq_correct_s8_state_t iq_correct;
+	spectrum_frame_t* frame;
 } specan_state_t;
 
-static const float log_k = 0.00000000001f; // to prevent log10f(0), which is bad...
+static_assert(sizeof(specan_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+
+static_assert(ARRAY_SIZE(window) == SPECAN_FFT_SIZE, "window size does not match FFT size");
+
+/* 2048 samples at 20MHz with a 200MHz core clock. Leave a quarter of the
+ * block period for the ISR, IPC and the UI core's bus traffic.
+ */
+static const uint32_t specan_cycles_budget = ((2048ULL * 200000000ULL) / 20000000ULL) * 3 / 4;
 
 void specan_init(void* const _state) {
 	specan_state_t* const state = (specan_state_t*)_state;
 
 	for(size_t i=0; i<ARRAY_SIZE(state->avg); i++) {
-		state->avg[i] = log_k;
-		state->peak[i] = log_k;
-		state->avg_log[i] = 0;
-		state->peak_log[i] = 0;
+		state->avg[i] = 0;
+		state->peak[i] = 0;
 	}
 	state->sample_frames = 16;
 	state->frame_count = 0;
-	const float mag_scale = 0.7071067811865476f / (256.0f * state->sample_frames);
+	state->ffts_accumulated = 0;
+	specan_configure(state, SPECAN_FFT_SIZE, 8);
+	const float mag_scale = 2.0f * 0.7071067811865476f / (256.0f * state->sample_frames);
 	state->mag_2_scale = mag_scale * mag_scale;
 	state->spectrum_floor = -4.5f;
 	state->spectrum_gain = 50.0f;
+	log_power_init(&state->peak_log_power, state->mag_2_scale, 0, state->spectrum_floor, state->spectrum_gain);
+	/* 64 blocks, about 6.5ms */
+	iq_correct_s8_init(&state->iq_correct, 6);
 }
 
-void specan_acknowledge_frame(void* const _state) {
+void specan_configure(void* const _state, const size_t fft_hop, const size_t ffts_per_block_max) {
 	specan_state_t* const state = (specan_state_t*)_state;
-	state->frame_count = 0;
+
+	/* Even, since IQ correction works on pairs of samples. */
+	state->fft_hop = std::max(std::min(fft_hop, (size_t)SPECAN_FFT_SIZE), (size_t)2) & ~(size_t)1;
+	state->ffts_per_block_max = std::max(ffts_per_block_max, (size_t)1);
+	state->ffts_per_block = 1;
 }
 
 static void specan_calculate_averages(specan_state_t* const state) {
+	/* Normalize to one FFT per block so the display calibration does not
+	 * depend on how many FFTs the CPU budget allowed.
+	 */
+	const float avg_scale = state->mag_2_scale * state->sample_frames / std::max(state->ffts_accumulated, (size_t)1);
+	state->ffts_accumulated = 0;
+
+	log_power_state_t avg_log_power;
+	log_power_init(&avg_log_power, avg_scale, 0, state->spectrum_floor, state->spectrum_gain);
+	log_power_u64_u8(&avg_log_power, state->avg, state->frame->avg, 256);
+
 	for(size_t i=0; i<256; i++) {
-		const float avg = state->avg[i];
-		state->avg[i] = log_k;
-		const float avg_log = log10f(avg * state->mag_2_scale);
-		const int avg_log_n = (int)roundf((avg_log - state->spectrum_floor) * state->spectrum_gain);
-		const uint8_t avg_n_log_sat = std::max(std::min(avg_log_n, 255), 0);
-		state->avg_log[i] = avg_n_log_sat;
+		state->avg[i] = 0;
 	}
 }
 
 static void specan_calculate_peaks(specan_state_t* const state) {
+	log_power_u32_u8(&state->peak_log_power, state->peak, state->frame->peak, 256);
+
 	for(size_t i=0; i<256; i++) {
-		const float peak = state->peak[i];
-		state->peak[i] = log_k;
-		const float peak_log = log10f(peak * state->mag_2_scale);
-		const int peak_log_n = (int)roundf((peak_log - state->spectrum_floor) * state->spectrum_gain);
-		const uint8_t peak_n_log_sat = std::max(std::min(peak_log_n, 255), 0);
-		state->peak_log[i] = peak_n_log_sat;
+		state->peak[i] = 0;
+	}
+}
+
+void specan_window_fft(const complex_s8_t* const in, complex_s16_t* const spectrum) {
+	/* int8 * Q15 window >> 8 leaves one bit of headroom, so the magnitude
+	 * stays within the FFT's limit. Bins come out at half the unscaled
+	 * float FFT magnitude, which mag_2_scale accounts for.
+	 */
+	complex_s16_t samples[SPECAN_FFT_SIZE];
+	for(uint32_t i=0; i<SPECAN_FFT_SIZE; i++) {
+		samples[i].i = (in[i].i * window[i]) >> 8;
+		samples[i].q = (in[i].q * window[i]) >> 8;
+	}
+
+	fft_c16(samples, spectrum, SPECAN_FFT_SIZE);
+}
+
+static void specan_accumulate_fft(specan_state_t* const state, const complex_s8_t* const in) {
+	complex_s16_t spectrum[SPECAN_FFT_SIZE];
+	specan_window_fft(in, spectrum);
+
+	for(size_t i=0; i<SPECAN_FFT_SIZE; i++) {
+		uint32_t bin;
+		memcpy(&bin, &spectrum[i], sizeof(bin));	/* Q:I, one LDR */
+		const uint32_t mag = __SMUAD(bin, bin);
+		state->avg[i] += mag;
+		if( mag > state->peak[i] ) {
+			state->peak[i] = mag;
+		}
 	}
 }
 
 void specan_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps) {
 	specan_state_t* const state = (specan_state_t*)_state;
-	(void)sample_count_in;
 	(void)timestamps;
 
 	// avg_log should be:
@@ -102,7 +153,11 @@ void specan_baseband_handler(void* const _state, complex_s8_t* const in, const s
 	//		-2.107210f (bin_mag=0.0078125, minimum non-zero signal)
 	//		 0.150515f (bin_mag=1.414..., peak I, peak Q).
 
+	/* The M4 always has a free frame slot, so there is no waiting on the
+	 * UI: convert into the slot over two blocks, publish, start again.
+	 */
 	if( state->frame_count == (state->sample_frames + 0) ) {
+		state->frame = spectrum_frames_write_begin(&device_state->spectrum_frames);
 		specan_calculate_averages(state);
 		state->frame_count += 1;
 		return;
@@ -110,39 +165,38 @@ void specan_baseband_handler(void* const _state, complex_s8_t* const in, const s
 
 	if( state->frame_count == (state->sample_frames + 1) ) {
 		specan_calculate_peaks(state);
-		state->frame_count += 1;
-		ipc_command_spectrum_data(&device_state->ipc_m0, state->avg_log, state->peak_log, 256);
-		return;
-	}
-
-	if( state->frame_count > (state->sample_frames + 1) ) {
-		/* Waiting for UI thread to claim the data and reset frame_count */
+		if( spectrum_frames_write_end(&device_state->spectrum_frames, state->frame) ) {
+			ipc_command_spectrum_data(&device_state->ipc_m0);
+		}
+		state->frame_count = 0;
 		return;
 	}
 
-	complex_t spectrum[256];
-	for(uint32_t i=0; i<256; i++) {
-		const uint32_t i_rev = __RBIT(i) >> 24;
-
-		const int32_t real = in[i].i;
-		const float real_f = (float)real;
-		spectrum[i_rev].r = real_f * window[i];
-		
-		const int32_t imag = in[i].q;
-		const float imag_f = (float)imag;
-		spectrum[i_rev].i = imag_f * window[i];
+	/* Welch: FFT the block in steps of fft_hop samples, as many times as
+	 * the cycle budget allowed last time. Cost is measured every block so
+	 * the count follows changes in load.
+	 *
+	 * DC and IQ imbalance are estimated from the start of each block, and
+	 * only the samples that get FFT'd are corrected, so the center bin
+	 * shows the signal instead of the LO leakage.
+	 */
+	const uint32_t start = baseband_timestamp();
+	iq_correct_s8_estimate(&state->iq_correct, in, SPECAN_FFT_SIZE);
+	size_t ffts = 0;
+	size_t corrected = 0;
+	for(size_t offset=0; (ffts < state->ffts_per_block) && ((offset + SPECAN_FFT_SIZE) <= sample_count_in); offset+=state->fft_hop) {
+		const size_t end = offset + SPECAN_FFT_SIZE;
+		iq_correct_s8(&state->iq_correct, &in[corrected], end - corrected);
+		corrected = end;
+		specan_accumulate_fft(state, &in[offset]);
+		ffts += 1;
 	}
-	
-	fft_c_preswapped((float*)spectrum, 256);
+	const uint32_t cycles = (start - baseband_timestamp()) & 0xffffff;
 
-	for(size_t i=0; i<256; i++) {
-		const float real = spectrum[i].r;
-		const float imag = spectrum[i].i;
-		const float mag = real * real + imag * imag;
-		state->avg[i] += mag;
-		if( mag > state->peak[i] ) {
-			state->peak[i] = mag;
-		}
+	if( ffts > 0 ) {
+		state->ffts_accumulated += ffts;
+		const uint32_t cycles_per_fft = std::max((uint32_t)(cycles / ffts), (uint32_t)1);
+		state->ffts_per_block = std::max(std::min((size_t)(specan_cycles_budget / cycles_per_fft), state->ffts_per_block_max), (size_t)1);
 	}
 
 	state->frame_count += 1;
@@ -28,8 +28,20 @@
 
 #include "complex.h"
 
+#define SPECAN_FFT_SIZE 256
+
 void specan_init(void* const _state);
+
+/* Welch averaging: up to ffts_per_block_max 256-point FFTs per DMA block,
+ * started every fft_hop samples (256 = no overlap, 128 = 50% overlap). The
+ * count actually used adapts to the measured cost of each FFT.
+ */
+void specan_configure(void* const _state, const size_t fft_hop, const size_t ffts_per_block_max);
 void specan_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps);
-void specan_acknowledge_frame(void* const _state);
+
+/* Hann window and FFT of in[0..SPECAN_FFT_SIZE-1], bins in FFT order (DC
+ * first). Shared with the sweep so both modes have the same calibration.
+ */
+void specan_window_fft(const complex_s8_t* const in, complex_s16_t* const spectrum);
 
 #endif/*__SPECAN_H__*/
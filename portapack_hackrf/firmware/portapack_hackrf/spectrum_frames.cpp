@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "spectrum_frames.h"
+
+#include "arm_intrinsics.h"
+
+#include <string.h>
+
+void spectrum_frames_init(spectrum_frames_t* const frames) {
+	for(size_t i=0; i<2; i++) {
+		frames->slot[i].sequence = 0;
+		memset(frames->slot[i].avg, 0, sizeof(frames->slot[i].avg));
+		memset(frames->slot[i].peak, 0, sizeof(frames->slot[i].peak));
+	}
+	frames->latest = 0;
+	frames->count = 0;
+	frames->doorbell_pending = 0;
+}
+
+spectrum_frame_t* spectrum_frames_write_begin(spectrum_frames_t* const frames) {
+	spectrum_frame_t* const frame = &frames->slot[frames->latest ^ 1];
+	frame->sequence = (frames->count * 2) + 1;
+	__DMB();
+	return frame;
+}
+
+bool spectrum_frames_write_end(spectrum_frames_t* const frames, spectrum_frame_t* const frame) {
+	__DMB();
+	frames->count += 1;
+	frame->sequence = frames->count * 2;
+	frames->latest = frame - &frames->slot[0];
+
+	if( frames->doorbell_pending ) {
+		/* M0 has not picked up the last one yet; it will find this one. */
+		return false;
+	}
+	frames->doorbell_pending = 1;
+	return true;
+}
+
+bool spectrum_frames_read_latest(spectrum_frames_t* const frames, spectrum_frame_t* const frame, uint32_t* const sequence) {
+	frames->doorbell_pending = 0;
+
+	for(size_t attempt=0; attempt<4; attempt++) {
+		const spectrum_frame_t* const slot = &frames->slot[frames->latest];
+		const uint32_t sequence_before = slot->sequence;
+		if( sequence_before & 1 ) {
+			continue;
+		}
+		if( sequence_before == *sequence ) {
+			return false;
+		}
+
+		__DMB();
+		memcpy(frame->avg, slot->avg, sizeof(frame->avg));
+		memcpy(frame->peak, slot->peak, sizeof(frame->peak));
+		__DMB();
+
+		if( slot->sequence == sequence_before ) {
+			frame->sequence = sequence_before;
+			*sequence = sequence_before;
+			return true;
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __SPECTRUM_FRAMES_H__
+#define __SPECTRUM_FRAMES_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SPECTRUM_FRAME_BINS 256
+
+/* Spectrum rows handed from the M4 to the M0 through shared SRAM.
+ *
+ * The M4 alternates between two slots and never waits: it writes the slot
+ * that is not the latest, then publishes it. A slot's sequence is odd while
+ * it is being written and even once complete. The M0 copies the latest
+ * slot and checks the sequence did not change during the copy, retrying
+ * if the M4 got there first, so it never draws a half-written row.
+ */
+typedef struct spectrum_frame_t {
+	volatile uint32_t sequence;
+	uint8_t avg[SPECTRUM_FRAME_BINS];
+	uint8_t peak[SPECTRUM_FRAME_BINS];
+} spectrum_frame_t;
+
+typedef struct spectrum_frames_t {
+	spectrum_frame_t slot[2];
+	volatile uint32_t latest;
+	uint32_t count;					/* M4 only */
+	volatile uint32_t doorbell_pending;	/* Set by M4, cleared by M0 */
+} spectrum_frames_t;
+
+void spectrum_frames_init(spectrum_frames_t* const frames);
+
+/* M4 side */
+spectrum_frame_t* spectrum_frames_write_begin(spectrum_frames_t* const frames);
+/* Returns true if the M0 should be notified. */
+bool spectrum_frames_write_end(spectrum_frames_t* const frames, spectrum_frame_t* const frame);
+
+/* M0 side. Copies the latest frame if it is newer than *sequence. */
+bool spectrum_frames_read_latest(spectrum_frames_t* const frames, spectrum_frame_t* const frame, uint32_t* const sequence);
+
+#endif/*__SPECTRUM_FRAMES_H__*/
@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "sweep.h"
+
+#include "arm_intrinsics.h"
+
+#include "specan.h"
+#include "log_power.h"
+
+#include "portapack_driver.h"
+#include "ipc_m0_client.h"
+
+#include <tuning.h>
+
+#include <algorithm>
+
+#include <string.h>
+
+#define SWEEP_SAMPLING_RATE 20000000
+#define SWEEP_ROW_BINS 256
+#define SWEEP_BIN_HZ (SWEEP_SAMPLING_RATE / SPECAN_FFT_SIZE)
+
+/* Each span keeps FFT bins +8..+71: the synthesizer is tuned below the
+ * span, so the DC spike and its neighbours are never stitched in, and the
+ * top kept bin (5.6MHz) is well inside the 7.5MHz baseband filter corner.
+ */
+#define SWEEP_SPAN_OFFSET_BINS 8
+#define SWEEP_SPAN_BINS (SPECAN_FFT_SIZE / 4)
+#define SWEEP_STEP_HZ ((int64_t)SWEEP_BIN_HZ * SWEEP_SPAN_BINS)
+#define SWEEP_SPAN_OFFSET_HZ ((int64_t)SWEEP_BIN_HZ * SWEEP_SPAN_OFFSET_BINS)
+
+/* Top of the synthesizer's tuning range. */
+#define SWEEP_FREQUENCY_MAX_HZ 6000000000LL
+
+#define SWEEP_SPAN_COUNT_MIN (SWEEP_ROW_BINS / SWEEP_SPAN_BINS)
+
+typedef struct sweep_state_t {
+	uint32_t power[SWEEP_ROW_BINS];
+	int64_t width_hz;
+	int64_t start_hz;
+	size_t span_count;
+	size_t span_index;
+	bool span_tuned;
+	size_t dwell_blocks;
+	size_t settle_blocks;
+	size_t block_count;
+	size_t sweep_blocks;
+	int64_t requested_width_hz;
+	size_t requested_dwell_blocks;
+	size_t requested_settle_blocks;
+	volatile bool reconfigure;
+	log_power_state_t log_power;
+} sweep_state_t;
+
+static_assert(sizeof(sweep_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+static_assert((SWEEP_SPAN_OFFSET_BINS + SWEEP_SPAN_BINS) <= (SPECAN_FFT_SIZE / 2), "sweep span runs into the negative frequencies");
+
+static void sweep_tune_span(sweep_state_t* const state, const size_t span_index) {
+	/* A span the synthesizer cannot reach is left empty in the row. */
+	const int64_t lo_hz = state->start_hz + (int64_t)span_index * SWEEP_STEP_HZ - SWEEP_SPAN_OFFSET_HZ;
+	state->span_tuned = set_freq(lo_hz);
+	state->span_index = span_index;
+	state->block_count = 0;
+}
+
+static void sweep_start(sweep_state_t* const state) {
+	if( state->reconfigure ) {
+		/* Enough spans that every row bin gets at least one FFT bin. */
+		const int64_t span_count = (state->requested_width_hz + SWEEP_STEP_HZ - 1) / SWEEP_STEP_HZ;
+		state->span_count = std::min(std::max(span_count, (int64_t)SWEEP_SPAN_COUNT_MIN), (int64_t)SWEEP_ROW_BINS);
+		state->width_hz = state->span_count * SWEEP_STEP_HZ;
+		state->dwell_blocks = std::max(state->requested_dwell_blocks, (size_t)1);
+		state->settle_blocks = state->requested_settle_blocks;
+		state->reconfigure = false;
+	}
+
+	/* Recentre on tuned_hz every pass, so tuning from the UI just works.
+	 * Near either end of the tuning range the row slides rather than
+	 * shrinks.
+	 */
+	const int64_t start_hz = device_state->tuned_hz - state->width_hz / 2;
+	const int64_t start_max_hz = SWEEP_FREQUENCY_MAX_HZ - state->width_hz;
+	state->start_hz = std::min(std::max(start_hz, SWEEP_SPAN_OFFSET_HZ), start_max_hz);
+	state->sweep_blocks = 0;
+	sweep_tune_span(state, 0);
+}
+
+void sweep_init(void* const _state) {
+	sweep_state_t* const state = (sweep_state_t*)_state;
+
+	for(size_t i=0; i<SWEEP_ROW_BINS; i++) {
+		state->power[i] = 0;
+	}
+
+	/* Same calibration as the specan peak trace. */
+	const float mag_scale = 2.0f * 0.7071067811865476f / (256.0f * 16);
+	log_power_init(&state->log_power, mag_scale * mag_scale, 0, -4.5f, 50.0f);
+
+	sweep_configure(state, 120000000, 1, 4);
+	sweep_start(state);
+}
+
+void sweep_configure(void* const _state, const int64_t width_hz, const size_t dwell_blocks, const size_t settle_blocks) {
+	sweep_state_t* const state = (sweep_state_t*)_state;
+
+	/* Called from the IPC ISR, which the baseband ISR can preempt, so only
+	 * record the request; the next pass picks it up from the handler.
+	 */
+	state->requested_width_hz = width_hz;
+	state->requested_dwell_blocks = dwell_blocks;
+	state->requested_settle_blocks = settle_blocks;
+	state->reconfigure = true;
+}
+
+static void sweep_accumulate_fft(sweep_state_t* const state, const size_t span_index, const complex_s8_t* const in) {
+	complex_s16_t spectrum[SPECAN_FFT_SIZE];
+	specan_window_fft(in, spectrum);
+
+	/* Span bin b (0 = lowest kept frequency) lands in row bin
+	 * (span_index * SWEEP_SPAN_BINS + b) * SWEEP_ROW_BINS / (span_count * SWEEP_SPAN_BINS).
+	 * Several FFT bins share a row bin once there are more than four spans;
+	 * max-hold keeps narrow carriers visible.
+	 */
+	const size_t row_base = span_index * SWEEP_SPAN_BINS;
+	const size_t row_divisor = state->span_count * SWEEP_SPAN_BINS;
+	for(size_t b=0; b<SWEEP_SPAN_BINS; b++) {
+		const size_t fft_bin = SWEEP_SPAN_OFFSET_BINS + b;
+		uint32_t bin;
+		memcpy(&bin, &spectrum[fft_bin], sizeof(bin));
+		const uint32_t mag = __SMUAD(bin, bin);
+		const size_t row_bin = ((row_base + b) * SWEEP_ROW_BINS) / row_divisor;
+		state->power[row_bin] = std::max(state->power[row_bin], mag);
+	}
+}
+
+static void sweep_publish_row(sweep_state_t* const state) {
+	/* The M0 draws spectrum rows in FFT order, so hand it the stitched row
+	 * rotated the same way: it reads as one 256-bin FFT centred on tuned_hz.
+	 */
+	static_assert(SWEEP_ROW_BINS == SPECTRUM_FRAME_BINS, "sweep row does not fit a spectrum frame");
+	spectrum_frame_t* const frame = spectrum_frames_write_begin(&device_state->spectrum_frames);
+
+	uint8_t row_linear[SWEEP_ROW_BINS];
+	log_power_u32_u8(&state->log_power, state->power, row_linear, SWEEP_ROW_BINS);
+	for(size_t i=0; i<SWEEP_ROW_BINS; i++) {
+		const size_t fft_bin = (i + SWEEP_ROW_BINS / 2) & (SWEEP_ROW_BINS - 1);
+		frame->avg[fft_bin] = frame->peak[fft_bin] = row_linear[i];
+		state->power[i] = 0;
+	}
+
+	/* Blocks are 2048 samples, so the pass took sweep_blocks * 2048 / fs. */
+	const uint64_t sample_count = (uint64_t)state->sweep_blocks * 2048;
+	device_state->dsp_metrics.sweep_mhz_per_s = ((uint64_t)state->width_hz * SWEEP_SAMPLING_RATE / 1000000) / sample_count;
+
+	if( spectrum_frames_write_end(&device_state->spectrum_frames, frame) ) {
+		ipc_command_spectrum_data(&device_state->ipc_m0);
+	}
+}
+
+void sweep_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps) {
+	sweep_state_t* const state = (sweep_state_t*)_state;
+	(void)sample_count_in;
+
+	state->sweep_blocks += 1;
+	state->block_count += 1;
+	if( state->block_count <= state->settle_blocks ) {
+		/* Synthesizer still settling after the retune */
+		return;
+	}
+
+	const bool last_block = (state->block_count >= (state->settle_blocks + state->dwell_blocks));
+	const size_t span_index = state->span_index;
+	const bool span_tuned = state->span_tuned;
+	if( last_block ) {
+		/* Retune first: this block is already captured, and the next
+		 * span's settling time runs while its FFT is computed.
+		 */
+		const size_t next_span_index = span_index + 1;
+		if( next_span_index < state->span_count ) {
+			sweep_tune_span(state, next_span_index);
+		}
+	}
+
+	if( span_tuned ) {
+		sweep_accumulate_fft(state, span_index, in);
+	}
+
+	timestamps->demodulate_end = baseband_timestamp();
+
+	if( last_block && ((span_index + 1) == state->span_count) ) {
+		sweep_publish_row(state);
+		sweep_start(state);
+	}
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __SWEEP_H__
+#define __SWEEP_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "portapack.h"
+
+#include "complex.h"
+
+/* Wideband sweep: retunes across tuned_hz +/- width/2 in 5MHz steps and
+ * stitches the spans into one 256-bin row. The synthesizer sits 625kHz
+ * below each span, so the kept FFT bins (+0.6 to +5.6MHz) miss the DC
+ * spike and stay inside the 15MHz baseband filter's passband. Spans the
+ * synthesizer cannot tune to are left empty.
+ *
+ * Per span: settle_blocks DMA blocks are dropped after the retune, then
+ * dwell_blocks are FFT'd and max-held. The retune for the next span is
+ * issued before the last dwell block is processed, so synthesizer settling
+ * overlaps that block's FFT. Fewer settle/dwell blocks sweep faster, more
+ * give cleaner and steadier rows.
+ */
+void sweep_init(void* const _state);
+void sweep_configure(void* const _state, const int64_t width_hz, const size_t dwell_blocks, const size_t settle_blocks);
+void sweep_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps);
+
+#endif/*__SWEEP_H__*/
@@ -24,263 +24,266 @@
 #ifndef __WINDOW_H__
 #define __WINDOW_H__
 
-const float window[256] = {
-	0.0000000000f,
-	0.0001517740f,
-	0.0006070039f,
-	0.0013654133f,
-	0.0024265418f,
-	0.0037897452f,
-	0.0054541958f,
-	0.0074188833f,
-	0.0096826148f,
-	0.0122440160f,
-	0.0151015320f,
-	0.0182534279f,
-	0.0216977902f,
-	0.0254325280f,
-	0.0294553737f,
-	0.0337638853f,
-	0.0383554469f,
-	0.0432272712f,
-	0.0483764003f,
-	0.0537997084f,
-	0.0594939029f,
-	0.0654555268f,
-	0.0716809611f,
-	0.0781664261f,
-	0.0849079846f,
-	0.0919015438f,
-	0.0991428580f,
-	0.1066275310f,
-	0.1143510188f,
-	0.1223086326f,
-	0.1304955414f,
-	0.1389067748f,
-	0.1475372265f,
-	0.1563816570f,
-	0.1654346968f,
-	0.1746908499f,
-	0.1841444969f,
-	0.1937898985f,
-	0.2036211990f,
-	0.2136324300f,
-	0.2238175135f,
-	0.2341702664f,
-	0.2446844034f,
-	0.2553535415f,
-	0.2661712036f,
-	0.2771308221f,
-	0.2882257437f,
-	0.2994492325f,
-	0.3107944750f,
-	0.3222545833f,
-	0.3338226003f,
-	0.3454915028f,
-	0.3572542069f,
-	0.3691035713f,
-	0.3810324025f,
-	0.3930334584f,
-	0.4050994533f,
-	0.4172230619f,
-	0.4293969241f,
-	0.4416136491f,
-	0.4538658203f,
-	0.4661459993f,
-	0.4784467310f,
-	0.4907605475f,
-	0.5030799733f,
-	0.5153975293f,
-	0.5277057375f,
-	0.5399971256f,
-	0.5522642316f,
-	0.5644996083f,
-	0.5766958274f,
-	0.5888454849f,
-	0.6009412046f,
-	0.6129756433f,
-	0.6249414949f,
-	0.6368314950f,
-	0.6486384253f,
-	0.6603551178f,
-	0.6719744593f,
-	0.6834893958f,
-	0.6948929366f,
-	0.7061781587f,
-	0.7173382109f,
-	0.7283663179f,
-	0.7392557846f,
-	0.7500000000f,
-	0.7605924414f,
-	0.7710266782f,
-	0.7812963758f,
-	0.7913952995f,
-	0.8013173182f,
-	0.8110564084f,
-	0.8206066574f,
-	0.8299622674f,
-	0.8391175587f,
-	0.8480669730f,
-	0.8568050772f,
-	0.8653265665f,
-	0.8736262674f,
-	0.8816991414f,
-	0.8895402873f,
-	0.8971449448f,
-	0.9045084972f,
-	0.9116264741f,
-	0.9184945542f,
-	0.9251085679f,
-	0.9314644998f,
-	0.9375584914f,
-	0.9433868430f,
-	0.9489460161f,
-	0.9542326359f,
-	0.9592434929f,
-	0.9639755449f,
-	0.9684259193f,
-	0.9725919141f,
-	0.9764710002f,
-	0.9800608227f,
-	0.9833592021f,
-	0.9863641361f,
-	0.9890738004f,
-	0.9914865498f,
-	0.9936009198f,
-	0.9954156265f,
-	0.9969295684f,
-	0.9981418264f,
-	0.9990516644f,
-	0.9996585301f,
-	0.9999620551f,
-	0.9999620551f,
-	0.9996585301f,
-	0.9990516644f,
-	0.9981418264f,
-	0.9969295684f,
-	0.9954156265f,
-	0.9936009198f,
-	0.9914865498f,
-	0.9890738004f,
-	0.9863641361f,
-	0.9833592021f,
-	0.9800608227f,
-	0.9764710002f,
-	0.9725919141f,
-	0.9684259193f,
-	0.9639755449f,
-	0.9592434929f,
-	0.9542326359f,
-	0.9489460161f,
-	0.9433868430f,
-	0.9375584914f,
-	0.9314644998f,
-	0.9251085679f,
-	0.9184945542f,
-	0.9116264741f,
-	0.9045084972f,
-	0.8971449448f,
-	0.8895402873f,
-	0.8816991414f,
-	0.8736262674f,
-	0.8653265665f,
-	0.8568050772f,
-	0.8480669730f,
-	0.8391175587f,
-	0.8299622674f,
-	0.8206066574f,
-	0.8110564084f,
-	0.8013173182f,
-	0.7913952995f,
-	0.7812963758f,
-	0.7710266782f,
-	0.7605924414f,
-	0.7500000000f,
-	0.7392557846f,
-	0.7283663179f,
-	0.7173382109f,
-	0.7061781587f,
-	0.6948929366f,
-	0.6834893958f,
-	0.6719744593f,
-	0.6603551178f,
-	0.6486384253f,
-	0.6368314950f,
-	0.6249414949f,
-	0.6129756433f,
-	0.6009412046f,
-	0.5888454849f,
-	0.5766958274f,
-	0.5644996083f,
-	0.5522642316f,
-	0.5399971256f,
-	0.5277057375f,
-	0.5153975293f,
-	0.5030799733f,
-	0.4907605475f,
-	0.4784467310f,
-	0.4661459993f,
-	0.4538658203f,
-	0.4416136491f,
-	0.4293969241f,
-	0.4172230619f,
-	0.4050994533f,
-	0.3930334584f,
-	0.3810324025f,
-	0.3691035713f,
-	0.3572542069f,
-	0.3454915028f,
-	0.3338226003f,
-	0.3222545833f,
-	0.3107944750f,
-	0.2994492325f,
-	0.2882257437f,
-	0.2771308221f,
-	0.2661712036f,
-	0.2553535415f,
-	0.2446844034f,
-	0.2341702664f,
-	0.2238175135f,
-	0.2136324300f,
-	0.2036211990f,
-	0.1937898985f,
-	0.1841444969f,
-	0.1746908499f,
-	0.1654346968f,
-	0.1563816570f,
-	0.1475372265f,
-	0.1389067748f,
-	0.1304955414f,
-	0.1223086326f,
-	0.1143510188f,
-	0.1066275310f,
-	0.0991428580f,
-	0.0919015438f,
-	0.0849079846f,
-	0.0781664261f,
-	0.0716809611f,
-	0.0654555268f,
-	0.0594939029f,
-	0.0537997084f,
-	0.0483764003f,
-	0.0432272712f,
-	0.0383554469f,
-	0.0337638853f,
-	0.0294553737f,
-	0.0254325280f,
-	0.0216977902f,
-	0.0182534279f,
-	0.0151015320f,
-	0.0122440160f,
-	0.0096826148f,
-	0.0074188833f,
-	0.0054541958f,
-	0.0037897452f,
-	0.0024265418f,
-	0.0013654133f,
-	0.0006070039f,
-	0.0001517740f,
-	0.0000000000f,
+#include <stdint.h>
+
+/* 256-point Hann, Q15 */
+const int16_t window[256] = {
+	0,
+	5,
+	20,
+	45,
+	80,
+	124,
+	179,
+	243,
+	317,
+	401,
+	495,
+	598,
+	711,
+	833,
+	965,
+	1106,
+	1257,
+	1416,
+	1585,
+	1763,
+	1949,
+	2145,
+	2349,
+	2561,
+	2782,
+	3011,
+	3249,
+	3494,
+	3747,
+	4008,
+	4276,
+	4552,
+	4834,
+	5124,
+	5421,
+	5724,
+	6034,
+	6350,
+	6672,
+	7000,
+	7334,
+	7673,
+	8018,
+	8367,
+	8722,
+	9081,
+	9445,
+	9812,
+	10184,
+	10560,
+	10939,
+	11321,
+	11707,
+	12095,
+	12486,
+	12879,
+	13274,
+	13672,
+	14070,
+	14471,
+	14872,
+	15275,
+	15678,
+	16081,
+	16485,
+	16889,
+	17292,
+	17695,
+	18097,
+	18498,
+	18897,
+	19295,
+	19692,
+	20086,
+	20478,
+	20868,
+	21255,
+	21639,
+	22019,
+	22397,
+	22770,
+	23140,
+	23506,
+	23867,
+	24224,
+	24576,
+	24923,
+	25265,
+	25602,
+	25932,
+	26258,
+	26577,
+	26890,
+	27196,
+	27496,
+	27789,
+	28076,
+	28355,
+	28627,
+	28892,
+	29148,
+	29398,
+	29639,
+	29872,
+	30097,
+	30314,
+	30522,
+	30722,
+	30913,
+	31095,
+	31268,
+	31432,
+	31588,
+	31733,
+	31870,
+	31997,
+	32115,
+	32223,
+	32321,
+	32410,
+	32489,
+	32558,
+	32618,
+	32667,
+	32707,
+	32737,
+	32757,
+	32767,
+	32767,
+	32757,
+	32737,
+	32707,
+	32667,
+	32618,
+	32558,
+	32489,
+	32410,
+	32321,
+	32223,
+	32115,
+	31997,
+	31870,
+	31733,
+	31588,
+	31432,
+	31268,
+	31095,
+	30913,
+	30722,
+	30522,
+	30314,
+	30097,
+	29872,
+	29639,
+	29398,
+	29148,
+	28892,
+	28627,
+	28355,
+	28076,
+	27789,
+	27496,
+	27196,
+	26890,
+	26577,
+	26258,
+	25932,
+	25602,
+	25265,
+	24923,
+	24576,
+	24224,
+	23867,
+	23506,
+	23140,
+	22770,
+	22397,
+	22019,
+	21639,
+	21255,
+	20868,
+	20478,
+	20086,
+	19692,
+	19295,
+	18897,
+	18498,
+	18097,
+	17695,
+	17292,
+	16889,
+	16485,
+	16081,
+	15678,
+	15275,
+	14872,
+	14471,
+	14070,
+	13672,
+	13274,
+	12879,
+	12486,
+	12095,
+	11707,
+	11321,
+	10939,
+	10560,
+	10184,
+	9812,
+	9445,
+	9081,
+	8722,
+	8367,
+	8018,
+	7673,
+	7334,
+	7000,
+	6672,
+	6350,
+	6034,
+	5724,
+	5421,
+	5124,
+	4834,
+	4552,
+	4276,
+	4008,
+	3747,
+	3494,
+	3249,
+	3011,
+	2782,
+	2561,
+	2349,
+	2145,
+	1949,
+	1763,
+	1585,
+	1416,
+	1257,
+	1106,
+	965,
+	833,
+	711,
+	598,
+	495,
+	401,
+	317,
+	243,
+	179,
+	124,
+	80,
+	45,
+	20,
+	5,
+	0,
 };
 
 #endif/*__WINDOW_H__*/
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "zoom.h"
+
+#include "arm_intrinsics.h"
+
+#include "decimate.h"
+#include "filters.h"
+#include "nco.h"
+#include "window.h"
+#include "fft.h"
+#include "log_power.h"
+
+#include "portapack_driver.h"
+#include "ipc_m0_client.h"
+
+#include <algorithm>
+
+#include <string.h>
+
+#define ZOOM_SAMPLING_RATE 20000000
+#define ZOOM_TRANSLATE_RATE (ZOOM_SAMPLING_RATE / 2)
+#define ZOOM_FFT_SIZE 256
+#define ZOOM_FACTOR_MIN 2
+#define ZOOM_FACTOR_MAX 256
+#define ZOOM_CIC_STAGES_MAX 6
+#define ZOOM_FRAME_FFTS 16
+
+typedef struct zoom_state_t {
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_state_t translate;
+	nco_cplx_s16_s16_state_t nco;
+	fir_cic3_decim_2_s16_s16_state_t cic[ZOOM_CIC_STAGES_MAX];
+	fir_hb_decim_2_cplx_s16_s16_state_t hb;
+	complex_s16_t samples[ZOOM_FFT_SIZE];
+	uint32_t avg[ZOOM_FFT_SIZE];
+	uint32_t peak[ZOOM_FFT_SIZE];
+	size_t zoom_factor;
+	size_t cic_count;
+	int32_t center_offset_hz;
+	size_t sample_count;
+	size_t ffts_accumulated;
+	bool publish_pending;
+	size_t requested_zoom_factor;
+	int32_t requested_center_offset_hz;
+	volatile bool reconfigure;
+	log_power_state_t peak_log_power;
+	log_power_state_t avg_log_power;
+} zoom_state_t;
+
+static_assert(sizeof(zoom_state_t) <= RECEIVER_STATE_BUFFER_SIZE, "receiver state too large");
+
+static_assert(ARRAY_SIZE(window) == ZOOM_FFT_SIZE, "window size does not match FFT size");
+static_assert(ZOOM_FFT_SIZE == SPECTRUM_FRAME_BINS, "zoom FFT does not fit a spectrum frame");
+static_assert((ZOOM_FACTOR_MAX >> (ZOOM_CIC_STAGES_MAX + 2)) == 1, "not enough CIC stages for the largest zoom");
+
+/* The last CIC stage at the largest zoom must still see a multiple of four
+ * samples per block.
+ */
+static_assert(((2048 / 2) >> (ZOOM_CIC_STAGES_MAX - 1)) % 4 == 0, "too many CIC stages for the block size");
+
+static void zoom_apply(zoom_state_t* const state) {
+	/* Round down to a power of two within range. */
+	const size_t factor = std::min(std::max(state->requested_zoom_factor, (size_t)ZOOM_FACTOR_MIN), (size_t)ZOOM_FACTOR_MAX);
+	state->zoom_factor = 1 << (31 - __builtin_clz(factor));
+
+	/* Factor 2 is the translate alone. From 4 up, CIC stages take it to
+	 * twice the output rate and the half-band does the last step, so
+	 * the bins near the edges are not full of CIC aliases.
+	 */
+	const size_t log2_factor = 31 - __builtin_clz(state->zoom_factor);
+	state->cic_count = (log2_factor >= 2) ? (log2_factor - 2) : 0;
+
+	/* Keep the zoomed band inside the translated band. */
+	const int32_t output_rate = ZOOM_SAMPLING_RATE / state->zoom_factor;
+	const int32_t offset_max = (ZOOM_TRANSLATE_RATE - output_rate) / 2;
+	state->center_offset_hz = std::min(std::max(state->requested_center_offset_hz, -offset_max), offset_max);
+
+	translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16_init(&state->translate);
+	nco_cplx_s16_s16_init(&state->nco, -state->center_offset_hz, ZOOM_TRANSLATE_RATE);
+	for(size_t i=0; i<ZOOM_CIC_STAGES_MAX; i++) {
+		fir_cic3_decim_2_s16_s16_init(&state->cic[i]);
+	}
+	fir_hb_decim_2_cplx_s16_s16_init(&state->hb, taps_23_hb, ARRAY_SIZE(taps_23_hb));
+
+	for(size_t i=0; i<ZOOM_FFT_SIZE; i++) {
+		state->avg[i] = 0;
+		state->peak[i] = 0;
+	}
+	state->sample_count = 0;
+	state->ffts_accumulated = 0;
+	state->publish_pending = false;
+	state->reconfigure = false;
+}
+
+void zoom_init(void* const _state) {
+	zoom_state_t* const state = (zoom_state_t*)_state;
+
+	/* Bins come out at half the specan scale: the translate has a gain of
+	 * 8, and the window product is shifted by 12 rather than 8. Same
+	 * floor and gain as specan, which also scales the mean power up by
+	 * its frame count for avg.
+	 */
+	const float mag_scale = 2.0f * 2.0f * 0.7071067811865476f / (256.0f * 16);
+	const float mag_2_scale = mag_scale * mag_scale;
+	log_power_init(&state->peak_log_power, mag_2_scale, 0, -4.5f, 50.0f);
+	log_power_init(&state->avg_log_power, mag_2_scale * ZOOM_FRAME_FFTS, 0, -4.5f, 50.0f);
+
+	zoom_configure(state, 16, 0);
+	zoom_apply(state);
+}
+
+void zoom_configure(void* const _state, const size_t zoom_factor, const int32_t center_offset_hz) {
+	zoom_state_t* const state = (zoom_state_t*)_state;
+
+	/* Called from the IPC ISR, which the baseband ISR can preempt, so only
+	 * record the request; the next block applies it.
+	 */
+	state->requested_zoom_factor = zoom_factor;
+	state->requested_center_offset_hz = center_offset_hz;
+	state->reconfigure = true;
+}
+
+static size_t zoom_decimate(zoom_state_t* const state, complex_s8_t* const in, const size_t sample_count_in) {
+	/* Every stage runs in place over the DMA block. */
+	complex_s16_t* const iq = (complex_s16_t*)in;
+	size_t n = translate_fs_over_4_and_decimate_by_2_cic_3_s8_s16(&state->translate, in, sample_count_in);
+
+	if( state->center_offset_hz != 0 ) {
+		n = nco_cplx_s16_s16(&state->nco, iq, iq, n);
+	}
+
+	/* Unity gain: the translate's gain of 8 stays, which leaves samples
+	 * well inside the FFT's input range.
+	 */
+	for(size_t i=0; i<state->cic_count; i++) {
+		n = fir_cic3_decim_2_s16_s16_shift<3, CIC_OUTPUT_ROUND_SATURATE>(&state->cic[i], iq, iq, n);
+	}
+
+	if( state->zoom_factor >= 4 ) {
+		n = fir_hb_decim_2_cplx_s16_s16(&state->hb, iq, iq, n);
+	}
+
+	return n;
+}
+
+static void zoom_accumulate_fft(zoom_state_t* const state) {
+	/* Translated samples are within +/-1024 (int8 times 8), so the Q15
+	 * window product >> 12 stays well under the FFT's input limit.
+	 */
+	for(size_t i=0; i<ZOOM_FFT_SIZE; i++) {
+		state->samples[i].i = (state->samples[i].i * window[i]) >> 12;
+		state->samples[i].q = (state->samples[i].q * window[i]) >> 12;
+	}
+
+	complex_s16_t spectrum[ZOOM_FFT_SIZE];
+	fft_c16(state->samples, spectrum, ZOOM_FFT_SIZE);
+
+	/* Each FFT adds 1/ZOOM_FRAME_FFTS of its power, so avg cannot overflow
+	 * and ends up the mean power.
+	 */
+	static_assert(ZOOM_FRAME_FFTS == 16, "average scaling assumes 16 FFTs per frame");
+	for(size_t i=0; i<ZOOM_FFT_SIZE; i++) {
+		uint32_t bin;
+		memcpy(&bin, &spectrum[i], sizeof(bin));
+		const uint32_t mag = __SMUAD(bin, bin);
+		state->avg[i] += mag >> 4;
+		state->peak[i] = std::max(state->peak[i], mag);
+	}
+
+	state->ffts_accumulated += 1;
+	if( state->ffts_accumulated == ZOOM_FRAME_FFTS ) {
+		state->publish_pending = true;
+	}
+}
+
+static void zoom_publish(zoom_state_t* const state) {
+	spectrum_frame_t* const frame = spectrum_frames_write_begin(&device_state->spectrum_frames);
+
+	log_power_u32_u8(&state->avg_log_power, state->avg, frame->avg, ZOOM_FFT_SIZE);
+	log_power_u32_u8(&state->peak_log_power, state->peak, frame->peak, ZOOM_FFT_SIZE);
+
+	for(size_t i=0; i<ZOOM_FFT_SIZE; i++) {
+		state->avg[i] = 0;
+		state->peak[i] = 0;
+	}
+	state->ffts_accumulated = 0;
+	state->publish_pending = false;
+
+	if( spectrum_frames_write_end(&device_state->spectrum_frames, frame) ) {
+		ipc_command_spectrum_data(&device_state->ipc_m0);
+	}
+}
+
+void zoom_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps) {
+	zoom_state_t* const state = (zoom_state_t*)_state;
+
+	if( state->reconfigure ) {
+		zoom_apply(state);
+	}
+
+	/* Filters run on every block to keep their state continuous, even
+	 * when the output is not used.
+	 */
+	const size_t n = zoom_decimate(state, in, sample_count_in);
+	const complex_s16_t* const iq = (const complex_s16_t*)in;
+
+	timestamps->decimate_end = baseband_timestamp();
+
+	/* At most one FFT or one frame conversion per block. At small zoom
+	 * factors a block holds more than one FFT's worth of samples, and the
+	 * rest is dropped; there is no cycle budget for more.
+	 */
+	if( state->publish_pending ) {
+		zoom_publish(state);
+		state->sample_count = 0;
+		return;
+	}
+
+	const size_t copy_count = std::min(n, ZOOM_FFT_SIZE - state->sample_count);
+	std::copy(&iq[0], &iq[copy_count], &state->samples[state->sample_count]);
+	state->sample_count += copy_count;
+
+	if( state->sample_count == ZOOM_FFT_SIZE ) {
+		zoom_accumulate_fft(state);
+		state->sample_count = 0;
+	}
+
+	timestamps->demodulate_end = baseband_timestamp();
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2014 Jared Boone, ShareBrained Technology, Inc.
+ *
+ * This file is part of PortaPack.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __ZOOM_H__
+#define __ZOOM_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "portapack.h"
+
+#include "complex.h"
+
+/* Zoom spectrum: narrows the band before the FFT instead of looking at all
+ * 20MHz, so each of the 256 bins covers 20MHz / zoom_factor / 256.
+ *
+ * The front end is the usual -fs/4 translate and CIC decimation by 2, then
+ * an NCO moves center_offset_hz (relative to tuned_hz) to DC, and more CIC
+ * stages plus a final half-band decimate to 20MHz / zoom_factor. Zoom
+ * factors are powers of two from 2 to 256. Frames go out through the
+ * spectrum frame slots, as for specan.
+ */
+void zoom_init(void* const _state);
+void zoom_configure(void* const _state, const size_t zoom_factor, const int32_t center_offset_hz);
+void zoom_baseband_handler(void* const _state, complex_s8_t* const in, const size_t sample_count_in, baseband_timestamps_t* const timestamps);
+
+#endif/*__ZOOM_H__*/